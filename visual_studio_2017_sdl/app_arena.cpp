@@ -0,0 +1,218 @@
+// ------------------------------------------------------------------------
+// App arenas: the objects of an app screen in one block of the heap
+// ------------------------------------------------------------------------
+//
+// Creating a screen allocates every object, ext, style list, animation and
+// label text on its own, and deleting it frees them one by one, so opening
+// and closing apps leaves holes all over the shared heap between the blocks
+// which stayed. Here an app screen takes one block of the heap and runs a
+// TLSF heap of its own in it. While the app is populated, lv_mem_alloc()
+// takes from there; its frees go back there, found by address. Deleting the
+// screen thus only touches the arena, and the heap gets the block back in
+// one piece once the last object is freed.
+//
+// An arena holds what is allocated while it is active, wherever it belongs.
+// Shared data created on the way (e.g. styles interned by style_pool) has to
+// be allocated with app_arena_begin(NULL), or it keeps the arena alive.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "tlsf_mem.h"
+#include "app_arena.h"
+#include "mem_profile.h"
+
+#if USE_APP_ARENA
+
+typedef struct
+{
+    lv_obj_t *screen;  // NULL: deleted
+    uint8_t *mem;      // block in the heap, NULL: unused
+    uint32_t size;
+    tlsf_t heap;
+    lv_signal_cb_t ancestor_signal;
+    uint32_t fallbacks; // allocations which didn't fit
+} arena_t;
+
+static arena_t arenas[APP_ARENA_MAX];
+static uint8_t num_arenas;
+
+static arena_t *current;                       // NULL: heap
+static arena_t *stack[APP_ARENA_MAX_DEPTH];
+static uint8_t depth;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static arena_t *find_by_screen(const lv_obj_t *screen)
+{
+    for (uint8_t i = 0; i < APP_ARENA_MAX; i++)
+    {
+        if (arenas[i].mem && (arenas[i].screen == screen))
+            return &arenas[i];
+    }
+    return NULL;
+}
+
+static arena_t *find_by_ptr(const void *ptr)
+{
+    if (!num_arenas)
+        return NULL;
+
+    for (uint8_t i = 0; i < APP_ARENA_MAX; i++)
+    {
+        arena_t *a = &arenas[i];
+        if (a->mem && ((uint8_t *)ptr >= a->mem) && ((uint8_t *)ptr < a->mem + a->size))
+            return a;
+    }
+    return NULL;
+}
+
+static void release(arena_t *a)
+{
+    MY_LOG("App arena: released, %d of %d bytes used at most, %d allocations from the heap",
+        tlsf_get_max_used(a->heap), a->size, a->fallbacks);
+
+    for (uint8_t i = 0; i < LV_MATH_MIN(depth, APP_ARENA_MAX_DEPTH); i++)
+    {
+        if (stack[i] == a)
+            stack[i] = NULL;
+    }
+    if (current == a)
+        current = NULL;
+
+    uint8_t *mem = a->mem;
+    memset(a, 0, sizeof(arena_t)); // no longer owns mem
+    num_arenas--;
+    tlsf_mem_free(mem);
+}
+
+static lv_res_t arena_signal(lv_obj_t *screen, lv_signal_t sign, void *param)
+{
+    arena_t *a = find_by_screen(screen);
+    lv_res_t res = a->ancestor_signal(screen, sign, param);
+
+    // children freed already, the screen itself follows: released with it
+    if (sign == LV_SIGNAL_CLEANUP)
+        a->screen = NULL;
+    return res;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+lv_obj_t *app_arena_create_screen(uint32_t size)
+{
+    arena_t *a = NULL;
+    for (uint8_t i = 0; !a && (i < APP_ARENA_MAX); i++)
+    {
+        if (!arenas[i].mem)
+            a = &arenas[i];
+    }
+    if (!a)
+    {
+        MY_LOG("App arena: none left");
+        return lv_obj_create(NULL, NULL);
+    }
+
+    app_arena_begin(NULL);
+    mem_profile_push(NULL, "app arena"); // the objects in it are listed by owner
+    a->mem = (uint8_t *)tlsf_mem_alloc(size);
+    mem_profile_pop();
+    app_arena_end();
+
+    a->heap = a->mem ? tlsf_create(a->mem, size) : NULL;
+    if (!a->heap)
+    {
+        MY_LOG("App arena: no room for %d bytes", size);
+        tlsf_mem_free(a->mem);
+        a->mem = NULL;
+        return lv_obj_create(NULL, NULL);
+    }
+    a->size = size;
+    num_arenas++;
+
+    app_arena_begin(NULL);
+    current = a; // the screen itself in the arena
+    lv_obj_t *screen = lv_obj_create(NULL, NULL);
+    app_arena_end();
+    if (!screen)
+    {
+        release(a);
+        return NULL;
+    }
+
+    a->screen = screen;
+    a->ancestor_signal = lv_obj_get_signal_cb(screen);
+    lv_obj_set_signal_cb(screen, arena_signal);
+    return screen;
+}
+
+void app_arena_begin(const lv_obj_t *screen)
+{
+    if (depth < APP_ARENA_MAX_DEPTH)
+        stack[depth] = current;
+    else
+        MY_LOG("App arena: nested too deep");
+    depth++;
+
+    current = screen ? find_by_screen(screen) : NULL;
+}
+
+void app_arena_end(void)
+{
+    if (!depth)
+        return;
+
+    depth--;
+    current = (depth < APP_ARENA_MAX_DEPTH) ? stack[depth] : NULL;
+}
+
+void *app_arena_alloc(size_t size)
+{
+    if (!current)
+        return NULL;
+
+    void *p = tlsf_malloc(current->heap, size);
+    if (!p)
+        current->fallbacks++;
+    return p;
+}
+
+bool app_arena_free(void *ptr)
+{
+    arena_t *a = find_by_ptr(ptr);
+    if (!a)
+        return false;
+
+    tlsf_free(a->heap, ptr);
+    if (!a->screen && !tlsf_get_used(a->heap))
+        release(a);
+    return true;
+}
+
+bool app_arena_owns(const void *ptr)
+{
+    return find_by_ptr(ptr) != NULL;
+}
+
+void app_arena_report(void)
+{
+    for (uint8_t i = 0; i < APP_ARENA_MAX; i++)
+    {
+        arena_t *a = &arenas[i];
+        if (a->mem)
+            MY_LOG("App arena %d: %d of %d bytes used (%d at most), %d allocations from the heap%s", i,
+                tlsf_get_used(a->heap), a->size, tlsf_get_max_used(a->heap), a->fallbacks, a->screen ? "" : ", screen deleted");
+    }
+
+    lv_mem_monitor_t mon;
+    mem_monitor(&mon);
+    MY_LOG("Heap: %d of %d bytes free in %d blocks, biggest %d, fragmentation %d%%",
+        mon.free_size, mon.total_size, mon.free_cnt, mon.free_biggest_size, mon.frag_pct);
+}
+
+#endif // USE_APP_ARENA
+
+// ------------------------------------------------------------------------
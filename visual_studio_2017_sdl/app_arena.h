@@ -0,0 +1,61 @@
+// ------------------------------------------------------------------------
+// App arenas: the objects of an app screen in one block of the heap
+// ------------------------------------------------------------------------
+
+#ifndef __APP_ARENA_H__
+#define __APP_ARENA_H__
+
+// 1: screens created by app_arena_create_screen() get their own heap
+//    (a TLSF heap in one block of the TLSF heap of lv_mem_alloc)
+#ifndef USE_APP_ARENA
+#define USE_APP_ARENA LV_MEM_TLSF
+#endif
+
+#define APP_ARENA_MAX       6
+#define APP_ARENA_SIZE      (4U * 1024U) // default, bytes incl. the TLSF control
+#define APP_ARENA_MAX_DEPTH 4            // nested app_arena_begin()
+
+#if USE_APP_ARENA
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// New screen with an arena of size bytes, allocated from the heap in one
+// block (a plain screen if there is no room). The screen itself is in the
+// arena. When the screen is deleted, its objects are freed into the arena
+// without touching the heap, and the arena goes back to the heap in one
+// block once it is empty (at once, unless something allocated in it lives on).
+lv_obj_t *app_arena_create_screen(uint32_t size);
+
+// Until app_arena_end(), lv_mem_alloc() takes memory for the screen: from
+// its arena as long as it has room, else (or if the screen has no arena)
+// from the heap. NULL: from the heap, for shared data outliving screens.
+void app_arena_begin(const lv_obj_t *screen);
+void app_arena_end(void);
+
+// used by tlsf_mem: NULL if no arena is active or it is full
+void *app_arena_alloc(size_t size);
+// used by tlsf_mem: false if the block isn't in an arena
+bool app_arena_free(void *ptr);
+bool app_arena_owns(const void *ptr);
+
+// logs the arenas and the fragmentation of the heap
+void app_arena_report(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define app_arena_create_screen(size) lv_obj_create(NULL, NULL)
+#define app_arena_begin(screen)
+#define app_arena_end()
+#define app_arena_report()
+
+#endif // USE_APP_ARENA
+
+#endif // __APP_ARENA_H__
+
+// ------------------------------------------------------------------------
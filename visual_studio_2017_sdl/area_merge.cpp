@@ -0,0 +1,319 @@
+// ------------------------------------------------------------------------
+// Cost-based merging of invalidated areas
+// ------------------------------------------------------------------------
+//
+// The refresh task of the display is wrapped. Before LVGL refreshes the
+// invalidated areas, they are merged by the active policy: the merged areas
+// are grown in place and the absorbed ones are marked in inv_area_joined,
+// exactly as LVGL's own join does. LVGL's join runs afterwards on the rest;
+// it only joins overlapping areas whose bounding box is smaller than the
+// sum, which the cost policy accepts anyway.
+//
+// The cost policy models the redraw of an area as
+//     px * AREA_MERGE_PX_NS + AREA_MERGE_AREA_NS
+// and merges two areas if the bounding box is cheaper than both separately.
+// E.g. the old and new box of a rotated hand overlap only partly and are
+// not joined by LVGL, but redrawing them as one area is usually cheaper.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "area_merge.h"
+
+#if USE_AREA_MERGE
+
+#define AREA_MERGE_MAX_SCENARIOS 8
+
+typedef struct
+{
+    const char *name;
+    uint32_t refreshes;
+    uint32_t inv_areas;     // as invalidated
+    uint32_t lvgl_areas;    // after LVGL join only
+    uint32_t lvgl_px;
+    uint32_t policy_areas;  // after policy and LVGL join
+    uint32_t policy_px;
+    uint32_t timed[2];      // refreshes measured with 0: LVGL join, 1: policy
+    uint32_t time_us[2];
+} scenario_t;
+
+static lv_task_cb_t refr_task_cb; // original
+static area_merge_policy_t policy = area_merge_policy_cost;
+static uint32_t px_ns   = AREA_MERGE_PX_NS;
+static uint32_t area_ns = AREA_MERGE_AREA_NS;
+
+#if USE_AREA_MERGE_STATS
+static scenario_t scenarios[AREA_MERGE_MAX_SCENARIOS];
+static uint16_t num_scenarios;
+static const char *next_scenario;
+
+// least squares fit of time = px * px_us + areas * area_us
+static double fit_pp, fit_pa, fit_aa, fit_tp, fit_ta;
+#endif
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+// same as lv_refr_join_area(): a single pass joining overlapping areas
+static void join_lvgl(lv_area_t *areas, uint8_t *joined, uint16_t num)
+{
+    lv_area_t area;
+    for (uint16_t in = 0; in < num; in++)
+    {
+        if (joined[in])
+            continue;
+
+        for (uint16_t from = 0; from < num; from++)
+        {
+            if (joined[from] || (in == from))
+                continue;
+
+            _lv_area_join(&area, &areas[in], &areas[from]);
+            if (area_merge_policy_lvgl(&areas[in], &areas[from], &area))
+            {
+                lv_area_copy(&areas[in], &area);
+                joined[from] = 1;
+            }
+        }
+    }
+}
+
+// repeated until stable, as a merged area may now pay off with another one
+static void join_policy(lv_area_t *areas, uint8_t *joined, uint16_t num)
+{
+    lv_area_t area;
+    bool merged;
+    do
+    {
+        merged = false;
+        for (uint16_t in = 0; in < num; in++)
+        {
+            if (joined[in])
+                continue;
+
+            for (uint16_t from = 0; from < num; from++)
+            {
+                if (joined[from] || (in == from))
+                    continue;
+
+                _lv_area_join(&area, &areas[in], &areas[from]);
+                if (policy(&areas[in], &areas[from], &area))
+                {
+                    lv_area_copy(&areas[in], &area);
+                    joined[from] = 1;
+                    merged = true;
+                }
+            }
+        }
+    } while (merged);
+}
+
+#if USE_AREA_MERGE_STATS
+
+static void sum_areas(const lv_area_t *areas, const uint8_t *joined, uint16_t num,
+    uint32_t *num_areas, uint32_t *num_px)
+{
+    for (uint16_t i = 0; i < num; i++)
+    {
+        if (joined[i])
+            continue;
+        (*num_areas)++;
+        *num_px += lv_area_get_size(&areas[i]);
+    }
+}
+
+static scenario_t *get_scenario(const char *name)
+{
+    if (!name)
+        name = "other";
+
+    for (uint16_t i = 0; i < num_scenarios; i++)
+    {
+        if ((scenarios[i].name == name) || !strcmp(scenarios[i].name, name))
+            return &scenarios[i];
+    }
+
+    if (num_scenarios >= AREA_MERGE_MAX_SCENARIOS)
+        return &scenarios[AREA_MERGE_MAX_SCENARIOS - 1]; // shared by the rest
+
+    scenario_t *s = &scenarios[num_scenarios++];
+    memset(s, 0, sizeof(*s));
+    s->name = name;
+    return s;
+}
+
+// estimated cost in us
+static uint32_t est_cost(uint32_t num_areas, uint32_t num_px)
+{
+    return (uint32_t)(((uint64_t)num_px * px_ns + (uint64_t)num_areas * area_ns) / 1000);
+}
+
+static void report_task_cb(lv_task_t *task)
+{
+    area_merge_report();
+}
+
+#endif // USE_AREA_MERGE_STATS
+
+static void refr_task(lv_task_t *task)
+{
+    lv_disp_t *disp = (lv_disp_t *)task->user_data;
+    uint16_t num = disp->inv_p;
+    if (!num)
+    {
+        refr_task_cb(task);
+        return;
+    }
+
+    bool use_policy = true;
+#if AREA_MERGE_AB
+    static bool toggle;
+    toggle = !toggle;
+    use_policy = toggle;
+#endif
+
+#if USE_AREA_MERGE_STATS
+    scenario_t *s = get_scenario(next_scenario);
+    next_scenario = NULL;
+
+    // simulate both on copies
+    lv_area_t areas[LV_INV_BUF_SIZE];
+    uint8_t joined[LV_INV_BUF_SIZE];
+
+    memcpy(areas, disp->inv_areas, num * sizeof(lv_area_t));
+    memset(joined, 0, num);
+    join_lvgl(areas, joined, num);
+    uint32_t lvgl_areas = 0, lvgl_px = 0;
+    sum_areas(areas, joined, num, &lvgl_areas, &lvgl_px);
+
+    memcpy(areas, disp->inv_areas, num * sizeof(lv_area_t));
+    memset(joined, 0, num);
+    join_policy(areas, joined, num);
+    join_lvgl(areas, joined, num);
+    uint32_t policy_areas = 0, policy_px = 0;
+    sum_areas(areas, joined, num, &policy_areas, &policy_px);
+
+    s->refreshes++;
+    s->inv_areas    += num;
+    s->lvgl_areas   += lvgl_areas;
+    s->lvgl_px      += lvgl_px;
+    s->policy_areas += policy_areas;
+    s->policy_px    += policy_px;
+#endif
+
+    if (use_policy)
+        join_policy(disp->inv_areas, disp->inv_area_joined, num);
+
+#if USE_AREA_MERGE_STATS
+    uint32_t start = get_time_us();
+    refr_task_cb(task);
+    uint32_t time = get_time_us() - start;
+
+    s->timed[use_policy]++;
+    s->time_us[use_policy] += time;
+
+    double a = use_policy ? policy_areas : lvgl_areas;
+    double p = use_policy ? policy_px : lvgl_px;
+    fit_pp += p * p;
+    fit_pa += p * a;
+    fit_aa += a * a;
+    fit_tp += time * p;
+    fit_ta += time * a;
+#else
+    refr_task_cb(task);
+#endif
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+bool area_merge_policy_lvgl(const lv_area_t *a, const lv_area_t *b, const lv_area_t *joined)
+{
+    return _lv_area_is_on(a, b) &&
+        (lv_area_get_size(joined) < lv_area_get_size(a) + lv_area_get_size(b));
+}
+
+bool area_merge_policy_cost(const lv_area_t *a, const lv_area_t *b, const lv_area_t *joined)
+{
+    // one area less to draw, but the gaps of the bounding box in addition
+    uint64_t merged   = (uint64_t)lv_area_get_size(joined) * px_ns;
+    uint64_t separate = ((uint64_t)lv_area_get_size(a) + lv_area_get_size(b)) * px_ns + area_ns;
+    return merged < separate;
+}
+
+void area_merge_init(lv_disp_t *disp)
+{
+    if (!disp || !disp->refr_task || (disp->refr_task->task_cb == refr_task))
+        return;
+
+    refr_task_cb = disp->refr_task->task_cb;
+    disp->refr_task->task_cb = refr_task;
+
+#if USE_AREA_MERGE_STATS
+    lv_task_create(report_task_cb, AREA_MERGE_REPORT_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+#endif
+}
+
+void area_merge_set_policy(area_merge_policy_t new_policy)
+{
+    policy = new_policy ? new_policy : area_merge_policy_cost;
+}
+
+void area_merge_set_cost(uint32_t new_px_ns, uint32_t new_area_ns)
+{
+    px_ns   = new_px_ns;
+    area_ns = new_area_ns;
+}
+
+void area_merge_scenario(const char *name)
+{
+#if USE_AREA_MERGE_STATS
+    next_scenario = name;
+#endif
+}
+
+void area_merge_report(void)
+{
+#if USE_AREA_MERGE_STATS
+    if (!num_scenarios)
+        return;
+
+    MY_LOG("Area merge (%d ns/px, %d ns/area), per refresh:", px_ns, area_ns);
+    MY_LOG("  %-12s %5s %5s | %-18s %7s | %-18s %7s | %9s",
+        "scenario", "refr", "inv", "LVGL areas/px", "est.us", "policy areas/px", "est.us", "us L/P");
+    for (uint16_t i = 0; i < num_scenarios; i++)
+    {
+        const scenario_t *s = &scenarios[i];
+        uint32_t n = s->refreshes;
+        uint32_t lvgl_cost   = est_cost(s->lvgl_areas, s->lvgl_px) / n;
+        uint32_t policy_cost = est_cost(s->policy_areas, s->policy_px) / n;
+        MY_LOG("  %-12s %5d %3d.%d | %3d.%d %12d %7d | %3d.%d %12d %7d | %4d %4d",
+            s->name, n, s->inv_areas / n, s->inv_areas * 10 / n % 10,
+            s->lvgl_areas / n, s->lvgl_areas * 10 / n % 10, s->lvgl_px / n, lvgl_cost,
+            s->policy_areas / n, s->policy_areas * 10 / n % 10, s->policy_px / n, policy_cost,
+            s->timed[0] ? s->time_us[0] / s->timed[0] : 0,
+            s->timed[1] ? s->time_us[1] / s->timed[1] : 0);
+    }
+
+    double det = fit_pp * fit_aa - fit_pa * fit_pa;
+    if (det > 1e-6 * fit_pp * fit_aa)
+    {
+        double px_us   = (fit_tp * fit_aa - fit_ta * fit_pa) / det;
+        double area_us = (fit_ta * fit_pp - fit_tp * fit_pa) / det;
+        MY_LOG("  measured fit: %d ns/px, %d ns/area", (int)(px_us * 1000), (int)(area_us * 1000));
+    }
+#endif
+}
+
+void area_merge_reset(void)
+{
+#if USE_AREA_MERGE_STATS
+    num_scenarios = 0;
+    fit_pp = fit_pa = fit_aa = fit_tp = fit_ta = 0;
+#endif
+}
+
+#endif // USE_AREA_MERGE
+
+// ------------------------------------------------------------------------
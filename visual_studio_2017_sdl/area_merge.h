@@ -0,0 +1,69 @@
+// ------------------------------------------------------------------------
+// Cost-based merging of invalidated areas
+// ------------------------------------------------------------------------
+
+#ifndef __AREA_MERGE_H__
+#define __AREA_MERGE_H__
+
+// 1: merge the invalidated areas by the policy below before LVGL refreshes them
+#ifndef USE_AREA_MERGE
+#define USE_AREA_MERGE 1
+#endif
+
+// 1: compare the policy with the LVGL join per scenario, log every period (for analysis only)
+#ifndef USE_AREA_MERGE_STATS
+#define USE_AREA_MERGE_STATS 0
+#endif
+#define AREA_MERGE_REPORT_PERIOD 10000 // ms
+
+// 1: alternate policy and LVGL join per refresh, to measure the time of both
+#ifndef AREA_MERGE_AB
+#define AREA_MERGE_AB 0
+#endif
+
+// cost model of the cost policy (see the fit in the report to calibrate)
+#define AREA_MERGE_PX_NS     50     // redraw and flush of one pixel
+#define AREA_MERGE_AREA_NS   100000 // fixed overhead of one area (tree walk, flush call)
+
+#if USE_AREA_MERGE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// return true to merge the areas a and b into joined (their bounding box)
+typedef bool (*area_merge_policy_t)(const lv_area_t *a, const lv_area_t *b, const lv_area_t *joined);
+
+// built-in policies
+bool area_merge_policy_lvgl(const lv_area_t *a, const lv_area_t *b, const lv_area_t *joined);
+bool area_merge_policy_cost(const lv_area_t *a, const lv_area_t *b, const lv_area_t *joined);
+
+// hook into the refresh task of the display, default policy: cost
+void area_merge_init(lv_disp_t *disp);
+void area_merge_set_policy(area_merge_policy_t policy);
+void area_merge_set_cost(uint32_t px_ns, uint32_t area_ns);
+
+// name the scenario of the next refresh (static string), e.g. before invalidating
+void area_merge_scenario(const char *name);
+
+void area_merge_report(void);
+void area_merge_reset(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define area_merge_init(disp)
+#define area_merge_set_policy(policy)
+#define area_merge_set_cost(px_ns, area_ns)
+#define area_merge_scenario(name)
+#define area_merge_report()
+#define area_merge_reset()
+
+#endif // USE_AREA_MERGE
+
+#endif // __AREA_MERGE_H__
+
+// ------------------------------------------------------------------------
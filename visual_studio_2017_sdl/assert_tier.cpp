@@ -0,0 +1,174 @@
+// ------------------------------------------------------------------------
+// Assertion tiers: cheap LVGL checks always, slow ones sampled
+// ------------------------------------------------------------------------
+//
+// With all checks of lv_conf.h enabled, every API call searches its object
+// in all screens and every critical operation walks the heap, so the debug
+// simulator runs an order of magnitude slower than release and timing bugs
+// disappear. Here the slow part of a check runs
+//   LV_ASSERT_TIER_SAMPLED: on every LV_ASSERT_SAMPLE_EVERY-th call of its
+//                           kind, or as long as the slow checks took less
+//                           than LV_ASSERT_BUDGET_PCT of the time
+//   LV_ASSERT_TIER_FULL:    always (as LVGL does, but measured)
+// The time of the slow checks is measured, the report shows their share.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "tlsf_mem.h"
+#include "assert_tier.h"
+
+#if LV_ASSERT_TIER
+
+enum { KIND_OBJ, KIND_STR, KIND_MEM, KIND_NUM };
+static const char *kind_names[KIND_NUM] = { "obj", "str", "mem" };
+
+typedef struct
+{
+    uint32_t calls;
+    uint32_t slow;    // slow checks run
+    uint64_t slow_us;
+} kind_stats_t;
+
+static kind_stats_t stats[KIND_NUM];
+static uint64_t slow_us;    // all kinds
+static uint64_t elapsed_us; // since assert_tier_init()
+static uint32_t last_us;
+static bool busy;           // LVGL calls within a check
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+// in steps, the us counter wraps after 71 minutes
+static void update_elapsed(void)
+{
+    uint32_t now = get_time_us();
+    if (last_us)
+        elapsed_us += (uint32_t)(now - last_us);
+    last_us = now;
+}
+
+// count the call, return true to run the slow check
+static bool sample(uint8_t kind)
+{
+    kind_stats_t *s = &stats[kind];
+    s->calls++;
+
+#if LV_ASSERT_TIER >= LV_ASSERT_TIER_FULL
+    return true;
+#elif LV_ASSERT_TIER >= LV_ASSERT_TIER_SAMPLED
+    if (LV_ASSERT_SAMPLE_EVERY && !(s->calls % LV_ASSERT_SAMPLE_EVERY))
+        return true;
+#if LV_ASSERT_BUDGET_PCT
+    update_elapsed();
+    return slow_us * 100 < elapsed_us * LV_ASSERT_BUDGET_PCT;
+#endif
+#endif
+    return false;
+}
+
+static void measured(uint8_t kind, uint32_t start)
+{
+    uint32_t us = get_time_us() - start;
+    stats[kind].slow++;
+    stats[kind].slow_us += us;
+    slow_us += us;
+}
+
+#if LV_ASSERT_REPORT_PERIOD
+static void report_task_cb(lv_task_t *task)
+{
+    assert_tier_report();
+}
+#endif
+
+// ------------------------------------------------------------------------
+// Checks
+// ------------------------------------------------------------------------
+
+bool assert_tier_obj(const void *obj, const char *obj_type)
+{
+    if (!lv_debug_check_null(obj))
+        return false;
+    if (busy || !sample(KIND_OBJ))
+        return true;
+
+    busy = true;
+    uint32_t start = get_time_us();
+    bool ok = lv_debug_check_obj_valid((const lv_obj_t *)obj) && // first: the type is asked from the object
+              lv_debug_check_obj_type((const lv_obj_t *)obj, obj_type);
+    measured(KIND_OBJ, start);
+    busy = false;
+    return ok;
+}
+
+bool assert_tier_str(const void *str)
+{
+    if (!lv_debug_check_null(str))
+        return false;
+    if (busy || !sample(KIND_STR))
+        return true;
+
+    busy = true;
+    uint32_t start = get_time_us();
+    bool ok = lv_debug_check_str(str);
+    measured(KIND_STR, start);
+    busy = false;
+    return ok;
+}
+
+bool assert_tier_mem_integrity(void)
+{
+    if (busy || !sample(KIND_MEM))
+        return true;
+
+    busy = true;
+    uint32_t start = get_time_us();
+#if LV_MEM_TLSF
+    bool ok = tlsf_mem_check(); // lv_mem_test() knows only the built-in heap
+#else
+    bool ok = (lv_mem_test() == LV_RES_OK);
+#endif
+    measured(KIND_MEM, start);
+    busy = false;
+    return ok;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+void assert_tier_init(void)
+{
+    last_us = get_time_us();
+#if LV_ASSERT_REPORT_PERIOD
+    static lv_task_t *report_task = NULL;
+    if (!report_task)
+        report_task = lv_task_create(report_task_cb, LV_ASSERT_REPORT_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+#endif
+}
+
+void assert_tier_report(void)
+{
+    update_elapsed();
+    uint32_t elapsed_ms = (uint32_t)(elapsed_us / 1000);
+    MY_LOG("Asserts (tier %d): %d ms in slow checks of %d ms (%d%%)", LV_ASSERT_TIER,
+        (uint32_t)(slow_us / 1000), elapsed_ms, elapsed_us ? (uint32_t)(slow_us * 100 / elapsed_us) : 0);
+
+    for (uint8_t i = 0; i < KIND_NUM; i++)
+    {
+        kind_stats_t *s = &stats[i];
+        if (s->calls)
+            MY_LOG("  %s: %d calls, %d slow checks, %d us, %d us each", kind_names[i], s->calls, s->slow,
+                (uint32_t)s->slow_us, s->slow ? (uint32_t)(s->slow_us / s->slow) : 0);
+    }
+}
+
+uint32_t assert_tier_get_time(void)
+{
+    return (uint32_t)slow_us;
+}
+
+#endif // LV_ASSERT_TIER
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+// ------------------------------------------------------------------------
+// Assertion tiers: cheap LVGL checks always, slow ones sampled
+// ------------------------------------------------------------------------
+
+#ifndef __ASSERT_TIER_H__
+#define __ASSERT_TIER_H__
+
+// Included by lv_conf.h (before the LVGL types), replaces the checks of
+// lv_debug.h. Slow are: LV_ASSERT_OBJ (searches the object in all screens),
+// LV_ASSERT_STR (scans the string), LV_ASSERT_MEM_INTEGRITY (walks the heap).
+// Their cheap part (NULL check) runs on every call.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LV_ASSERT_TIER_OFF     0 // no checks (LV_USE_DEBUG 0)
+#define LV_ASSERT_TIER_CHEAP   1 // NULL and style checks only
+#define LV_ASSERT_TIER_SAMPLED 2 // cheap checks always, slow ones sampled
+#define LV_ASSERT_TIER_FULL    3 // all checks on every call, as LVGL
+
+#ifndef LV_ASSERT_TIER
+#define LV_ASSERT_TIER LV_ASSERT_TIER_SAMPLED
+#endif
+#ifndef LV_ASSERT_SAMPLE_EVERY
+#define LV_ASSERT_SAMPLE_EVERY 100 // slow check on every Nth call, 0: not by count
+#endif
+#ifndef LV_ASSERT_BUDGET_PCT
+#define LV_ASSERT_BUDGET_PCT   0   // slow checks while below this share of the time, 0: none
+#endif
+#define LV_ASSERT_REPORT_PERIOD 0     // ms, 0: no periodic report
+
+#if LV_ASSERT_TIER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool assert_tier_obj(const void *obj, const char *obj_type);
+bool assert_tier_str(const void *str);
+bool assert_tier_mem_integrity(void);
+
+// start the periodic report (if LV_ASSERT_REPORT_PERIOD)
+void assert_tier_init(void);
+
+// log the checks per kind: calls, slow checks and their time
+void assert_tier_report(void);
+uint32_t assert_tier_get_time(void); // us spent in slow checks
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+// hooks of lv_debug.h
+#define LV_DEBUG_IS_OBJ(obj_p, obj_type) assert_tier_obj(obj_p, obj_type)
+#define LV_DEBUG_IS_STR(str)             assert_tier_str(str)
+#define LV_DEBUG_IS_MEM_INTEGRITY()      assert_tier_mem_integrity()
+
+#else // compiled out
+
+#define assert_tier_init()
+#define assert_tier_report()
+#define assert_tier_get_time() 0
+
+#endif // LV_ASSERT_TIER
+
+#endif // __ASSERT_TIER_H__
+
+// ------------------------------------------------------------------------
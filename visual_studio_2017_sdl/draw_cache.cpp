@@ -0,0 +1,315 @@
+// ------------------------------------------------------------------------
+// Draw descriptor cache: resolved styles per object, part and state
+// ------------------------------------------------------------------------
+//
+// lv_obj_init_draw_label_dsc() and lv_obj_init_draw_rect_dsc() get each
+// property by walking the style list of the part (transition, local, added
+// and theme styles, in each for the best matching state) and, for inherited
+// properties, the lists of the parents. For the stopwatch, redrawn at 100 Hz,
+// and the moving level bubble, this is repeated on every draw although the
+// result only changes with the styles or the state.
+//
+// Here the resolved descriptor is kept per object, part and state. LVGL
+// signals LV_SIGNAL_STYLE_CHG to the object (and its children) when styles
+// are added or removed, a shared style is reported modified, the theme is
+// changed or a layout relevant property is set; this invalidates all
+// descriptors of the object. Colors and opacities set as local style only
+// invalidate the area, also on a parent they are inherited from. So each
+// descriptor keeps a signature of the local styles of its part and of the
+// parents' main parts (a few bytes of property map each), compared on every
+// draw. The state of the part is looked up on each draw and is part of the
+// key, so pressed/released toggles between two valid descriptors. While a
+// style transition is running (on the part or a parent), its style changes
+// every frame without a signal, and the cache is bypassed.
+//
+// Only the own design callbacks use it (num_label and the LED wrapper); the
+// widgets of LVGL itself resolve their styles as before.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "draw_cache.h"
+#include "app_arena.h"
+
+#if USE_DRAW_CACHE
+
+enum { DSC_LABEL, DSC_RECT };
+
+typedef struct
+{
+    bool valid;
+    uint8_t kind;
+    uint8_t part;
+    lv_state_t state;
+    uint32_t local_sig; // get_local_sig() when resolved
+    union
+    {
+        lv_draw_label_dsc_t label;
+        lv_draw_rect_dsc_t rect;
+    } dsc;
+} dsc_t;
+
+typedef struct
+{
+    lv_obj_t *obj;                  // NULL: unused
+    lv_signal_cb_t ancestor_signal;
+    lv_design_cb_t ancestor_design; // LED only
+    uint8_t next;                   // replaced next if no descriptor is free
+    dsc_t dscs[DRAW_CACHE_MAX_DSCS];
+} entry_t;
+
+static entry_t entries[DRAW_CACHE_MAX_OBJS];
+static draw_cache_stats_t stats;
+static bool enabled = true;
+
+static lv_task_t *report_task;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static entry_t *find_entry(const lv_obj_t *obj)
+{
+    for (uint16_t i = 0; i < DRAW_CACHE_MAX_OBJS; i++)
+    {
+        if (entries[i].obj == obj)
+            return &entries[i];
+    }
+    return NULL;
+}
+
+static void invalidate(entry_t *e)
+{
+    for (uint8_t i = 0; i < DRAW_CACHE_MAX_DSCS; i++)
+        e->dscs[i].valid = false;
+    stats.invalidations++;
+}
+
+static lv_res_t draw_cache_signal(lv_obj_t *obj, lv_signal_t sign, void *param)
+{
+    entry_t *e = find_entry(obj);
+    lv_res_t res = e->ancestor_signal(obj, sign, param);
+
+    if ((sign == LV_SIGNAL_STYLE_CHG) || (sign == LV_SIGNAL_BASE_DIR_CHG))
+        invalidate(e);
+    else if (sign == LV_SIGNAL_CLEANUP)
+        memset(e, 0, sizeof(entry_t));
+    return res;
+}
+
+// Local style of the part and of the main parts of the parents (inherited
+// properties). Setting a property that is not layout relevant changes the
+// map in place (or reallocates it for a new property) without a signal.
+// False while one of these lists runs a style transition.
+static bool get_local_sig(const lv_obj_t *obj, uint8_t part, uint32_t *sig)
+{
+    *sig = 0;
+    for (; obj; obj = lv_obj_get_parent(obj), part = LV_OBJ_PART_MAIN)
+    {
+        lv_style_list_t *list = lv_obj_get_style_list(obj, part);
+        if (!list)
+            continue;
+        if (list->has_trans)
+            return false;
+
+        lv_style_t *local = lv_style_list_get_local_style(list);
+        *sig = *sig * 31 + (uint32_t)(uintptr_t)(local ? local->map : NULL);
+        if (!local || !local->map)
+            continue;
+
+        uint16_t size = _lv_style_get_mem_size(local);
+        for (uint16_t i = 0; i < size; i++)
+            *sig = *sig * 31 + local->map[i];
+    }
+    return true;
+}
+
+static void report_task_cb(lv_task_t *task)
+{
+    draw_cache_report();
+}
+
+static entry_t *add_entry(lv_obj_t *obj)
+{
+    entry_t *e = find_entry(NULL);
+    if (!e)
+        return NULL;
+
+    e->obj = obj;
+    e->ancestor_signal = lv_obj_get_signal_cb(obj);
+    lv_obj_set_signal_cb(obj, draw_cache_signal);
+    return e;
+}
+
+static void resolve(lv_obj_t *obj, uint8_t part, uint8_t kind, void *dsc)
+{
+    uint32_t start = get_time_us();
+
+    if (kind == DSC_LABEL)
+    {
+        lv_draw_label_dsc_init((lv_draw_label_dsc_t *)dsc);
+        lv_obj_init_draw_label_dsc(obj, part, (lv_draw_label_dsc_t *)dsc);
+    }
+    else
+    {
+        lv_draw_rect_dsc_init((lv_draw_rect_dsc_t *)dsc);
+        lv_obj_init_draw_rect_dsc(obj, part, (lv_draw_rect_dsc_t *)dsc);
+    }
+
+    stats.resolves++;
+    stats.resolve_time_us += get_time_us() - start;
+}
+
+static void get_dsc(lv_obj_t *obj, uint8_t part, uint8_t kind, void *dsc, size_t size)
+{
+#if DRAW_CACHE_REPORT_PERIOD
+    if (!report_task)
+    {
+        app_arena_begin(NULL); // outlives the screen being populated
+        report_task = lv_task_create(report_task_cb, DRAW_CACHE_REPORT_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+        app_arena_end();
+    }
+#endif
+
+    entry_t *e = NULL;
+    uint32_t sig;
+    if (enabled && get_local_sig(obj, part, &sig))
+    {
+        e = find_entry(obj);
+        if (!e)
+            e = add_entry(obj);
+    }
+    if (!e)
+    {
+        resolve(obj, part, kind, dsc);
+        return;
+    }
+
+    lv_state_t state = lv_obj_get_state(obj, part);
+    dsc_t *d = NULL;
+    for (uint8_t i = 0; i < DRAW_CACHE_MAX_DSCS; i++)
+    {
+        dsc_t *c = &e->dscs[i];
+        if (c->valid && (c->kind == kind) && (c->part == part) && (c->state == state))
+        {
+            if (c->local_sig == sig)
+            {
+                memcpy(dsc, &c->dsc, size);
+                stats.hits++;
+                return;
+            }
+            c->valid = false; // local style changed
+            stats.invalidations++;
+        }
+        if (!c->valid && !d)
+            d = c;
+    }
+
+    if (!d)
+    {
+        d = &e->dscs[e->next];
+        e->next = (e->next + 1) % DRAW_CACHE_MAX_DSCS;
+    }
+
+    resolve(obj, part, kind, &d->dsc);
+    d->valid = true;
+    d->kind = kind;
+    d->part = part;
+    d->state = state;
+    d->local_sig = sig;
+    memcpy(dsc, &d->dsc, size);
+}
+
+// as lv_led_design(): colors mixed with black and shadow scaled by the brightness
+static lv_design_res_t led_design(lv_obj_t *led, const lv_area_t *clip_area, lv_design_mode_t mode)
+{
+    if (mode != LV_DESIGN_DRAW_MAIN)
+        return find_entry(led)->ancestor_design(led, clip_area, mode);
+
+    lv_draw_rect_dsc_t dsc;
+    draw_cache_init_rect_dsc(led, LV_LED_PART_MAIN, &dsc);
+
+    uint8_t bright = lv_led_get_bright(led);
+    if (bright != LV_LED_BRIGHT_MAX)
+    {
+        dsc.bg_color = lv_color_mix(dsc.bg_color, LV_COLOR_BLACK, bright);
+        dsc.bg_grad_color = lv_color_mix(dsc.bg_grad_color, LV_COLOR_BLACK, bright);
+        dsc.border_color = lv_color_mix(dsc.border_color, LV_COLOR_BLACK, bright);
+        dsc.shadow_color = lv_color_mix(dsc.shadow_color, LV_COLOR_BLACK, bright);
+        dsc.shadow_width = ((bright - LV_LED_BRIGHT_MIN) * dsc.shadow_width) / (LV_LED_BRIGHT_MAX - LV_LED_BRIGHT_MIN);
+        dsc.shadow_spread = ((bright - LV_LED_BRIGHT_MIN) * dsc.shadow_spread) / (LV_LED_BRIGHT_MAX - LV_LED_BRIGHT_MIN);
+    }
+
+    lv_draw_rect(&led->coords, clip_area, &dsc);
+    return LV_DESIGN_RES_OK;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+void draw_cache_init_label_dsc(lv_obj_t *obj, uint8_t part, lv_draw_label_dsc_t *dsc)
+{
+    get_dsc(obj, part, DSC_LABEL, dsc, sizeof(lv_draw_label_dsc_t));
+}
+
+void draw_cache_init_rect_dsc(lv_obj_t *obj, uint8_t part, lv_draw_rect_dsc_t *dsc)
+{
+    get_dsc(obj, part, DSC_RECT, dsc, sizeof(lv_draw_rect_dsc_t));
+}
+
+void draw_cache_invalidate(lv_obj_t *obj)
+{
+    entry_t *e = find_entry(obj);
+    if (e)
+        invalidate(e);
+}
+
+void draw_cache_attach_led(lv_obj_t *led)
+{
+    entry_t *e = find_entry(led);
+    if (!e)
+        e = add_entry(led);
+    if (!e)
+        return; // drawn by LVGL
+
+    e->ancestor_design = lv_obj_get_design_cb(led);
+    lv_obj_set_design_cb(led, led_design);
+}
+
+void draw_cache_enable(bool enable)
+{
+    enabled = enable;
+    for (uint16_t i = 0; i < DRAW_CACHE_MAX_OBJS; i++)
+    {
+        if (entries[i].obj)
+            invalidate(&entries[i]);
+    }
+}
+
+void draw_cache_frame_done(void)
+{
+    stats.frames++;
+}
+
+void draw_cache_get_stats(draw_cache_stats_t *stats_p)
+{
+    *stats_p = stats;
+}
+
+void draw_cache_report(void)
+{
+    uint32_t draws = stats.hits + stats.resolves;
+    if (!draws || !stats.frames)
+        return;
+
+    MY_LOG("Draw cache: %d frames, %d descriptors (%d.%02d per frame), %d resolved (%d.%02d per frame), %d invalidations",
+        stats.frames, draws, draws / stats.frames, draws * 100 / stats.frames % 100,
+        stats.resolves, stats.resolves / stats.frames, stats.resolves * 100 / stats.frames % 100, stats.invalidations);
+    if (stats.resolves)
+        MY_LOG("Draw cache: %d us resolving styles (%d ns per descriptor)",
+            stats.resolve_time_us, stats.resolve_time_us * 1000 / stats.resolves);
+}
+
+#endif // USE_DRAW_CACHE
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+// ------------------------------------------------------------------------
+// Draw descriptor cache: resolved styles per object, part and state
+// ------------------------------------------------------------------------
+
+#ifndef __DRAW_CACHE_H__
+#define __DRAW_CACHE_H__
+
+// 1: keep the draw descriptors resolved from the styles of an object,
+//    instead of walking its style lists on every redraw
+#ifndef USE_DRAW_CACHE
+#define USE_DRAW_CACHE 1
+#endif
+
+#define DRAW_CACHE_MAX_OBJS      12    // objects with cached descriptors
+#define DRAW_CACHE_MAX_DSCS      4     // per object (part, state and kind)
+#define DRAW_CACHE_REPORT_PERIOD 0     // ms, 0: no periodic report
+
+#if USE_DRAW_CACHE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t hits;             // descriptor copied from the cache
+    uint32_t resolves;         // descriptor resolved from the style lists
+    uint32_t resolve_time_us;  // spent in lv_obj_init_draw_..._dsc()
+    uint32_t invalidations;
+} draw_cache_stats_t;
+
+// As lv_draw_..._dsc_init() and lv_obj_init_draw_..._dsc(): the descriptor is
+// resolved once per part and state of the object and copied from then on.
+// The cache is invalidated by LV_SIGNAL_STYLE_CHG (styles added or removed,
+// shared styles reported by lv_obj_report_style_mod(), layout relevant
+// properties, theme changes) and by any change of the local styles of the
+// object or its parents (lv_obj_set_style_local_...()). It is bypassed during
+// style transitions, also of a parent. A new state of the part is a
+// different key.
+void draw_cache_init_label_dsc(lv_obj_t *obj, uint8_t part, lv_draw_label_dsc_t *dsc);
+void draw_cache_init_rect_dsc(lv_obj_t *obj, uint8_t part, lv_draw_rect_dsc_t *dsc);
+
+// drop the descriptors of the object, e.g. after a shared style was modified
+// without lv_obj_report_style_mod()
+void draw_cache_invalidate(lv_obj_t *obj);
+
+// draw the LED (main part) from a cached descriptor
+void draw_cache_attach_led(lv_obj_t *led);
+
+// false: always resolve the descriptors, for comparison
+void draw_cache_enable(bool enable);
+
+// call at the end of each display refresh (e.g. from the monitor_cb)
+void draw_cache_frame_done(void);
+
+void draw_cache_get_stats(draw_cache_stats_t *stats);
+void draw_cache_report(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define draw_cache_init_label_dsc(obj, part, dsc) do { lv_draw_label_dsc_init(dsc); lv_obj_init_draw_label_dsc(obj, part, dsc); } while (0)
+#define draw_cache_init_rect_dsc(obj, part, dsc)  do { lv_draw_rect_dsc_init(dsc); lv_obj_init_draw_rect_dsc(obj, part, dsc); } while (0)
+#define draw_cache_invalidate(obj)
+#define draw_cache_attach_led(led)
+#define draw_cache_enable(enable)
+#define draw_cache_frame_done()
+#define draw_cache_report()
+
+#endif // USE_DRAW_CACHE
+
+#endif // __DRAW_CACHE_H__
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,427 @@
+// ------------------------------------------------------------------------
+// Glyph descriptor and bitmap cache
+// ------------------------------------------------------------------------
+//
+// A wrapped font forwards to the original font, but reports all glyphs as
+// 8 bpp and returns their coverage (A8) from an LRU cache. A glyph is thus
+// decoded (or decompressed, e.g. lv_font_montserrat_28_compressed) once,
+// and lv_draw_letter takes its 8 bpp path without an opacity table.
+//
+// The descriptors are kept in a direct-mapped table per font, keyed by the
+// letter and, if the font has kerning, the next letter. A hit skips the
+// cmap search (binary search in sparse ranges, e.g. the CJK font) and the
+// kerning search of lv_font_fmt_txt. Text is measured and drawn letter by
+// letter, so each letter of a label is looked up several times per draw.
+//
+// The bitmap cache is keyed by (font, code point). LVGL v7 places glyphs on whole
+// pixels, so there is no subpixel offset to key on; fonts with subpixel
+// rendering (3 values per pixel) are not wrapped.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "font_cache.h"
+#include "app_arena.h"
+#include "font_lazy.h"
+
+#if USE_FONT_CACHE
+
+#define FONT_CACHE_BUCKETS 64 // power of 2
+
+typedef struct _glyph_t
+{
+    struct _glyph_t *hnext;            // hash chain
+    struct _glyph_t *prev, *next;      // LRU list, most recent first
+    const lv_font_t *font;             // original
+    uint32_t letter;
+    uint16_t size;                     // of bitmap
+    uint8_t bitmap[1];                 // A8, box_w * box_h
+} glyph_t;
+
+typedef struct
+{
+    uint32_t letter;                   // 0: empty
+    uint32_t letter_next;
+    lv_font_glyph_dsc_t dsc;           // as returned by the wrapper
+} dsc_slot_t;
+
+typedef struct
+{
+    lv_font_t font;                    // wrapper, must be first
+    const lv_font_t *base;
+    bool kerning;                      // letter_next is part of the key
+    dsc_slot_t slots[FONT_CACHE_DSC_SLOTS];
+} wrap_t;
+
+static wrap_t wraps[FONT_CACHE_MAX_FONTS];
+static uint16_t num_wraps;
+
+static glyph_t *buckets[FONT_CACHE_BUCKETS];
+static glyph_t *lru_head, *lru_tail;
+static font_cache_stats_t stats;
+
+static lv_task_t *report_task;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static inline uint32_t hash(const lv_font_t *font, uint32_t letter)
+{
+    return ((uint32_t)(uintptr_t)font ^ (letter * 2654435761U)) & (FONT_CACHE_BUCKETS - 1);
+}
+
+static void lru_unlink(glyph_t *g)
+{
+    if (g->prev)
+        g->prev->next = g->next;
+    else
+        lru_head = g->next;
+    if (g->next)
+        g->next->prev = g->prev;
+    else
+        lru_tail = g->prev;
+}
+
+static void lru_push(glyph_t *g)
+{
+    g->prev = NULL;
+    g->next = lru_head;
+    if (lru_head)
+        lru_head->prev = g;
+    lru_head = g;
+    if (!lru_tail)
+        lru_tail = g;
+}
+
+static void remove_glyph(glyph_t *g)
+{
+    glyph_t **p = &buckets[hash(g->font, g->letter)];
+    while (*p != g)
+        p = &(*p)->hnext;
+    *p = g->hnext;
+
+    lru_unlink(g);
+    stats.bytes -= g->size;
+    stats.glyphs--;
+    lv_mem_free(g);
+}
+
+static glyph_t *find_glyph(const lv_font_t *font, uint32_t letter)
+{
+    for (glyph_t *g = buckets[hash(font, letter)]; g; g = g->hnext)
+    {
+        if ((g->font == font) && (g->letter == letter))
+            return g;
+    }
+    return NULL;
+}
+
+// unpack 1, 2, 3 (stored as 4) and 4 bpp to 8 bpp, rows are not padded
+static void decode(const uint8_t *src, uint8_t bpp, uint8_t *dst, uint32_t num_px)
+{
+    if (bpp == 3)
+        bpp = 4;
+
+    if (bpp == 8)
+    {
+        memcpy(dst, src, num_px);
+        return;
+    }
+
+    uint8_t max = (1 << bpp) - 1;
+    uint32_t bit = 0;
+    for (uint32_t i = 0; i < num_px; i++, bit += bpp)
+    {
+        uint8_t val = (src[bit >> 3] >> (8 - bpp - (bit & 7))) & max;
+        dst[i] = (uint8_t)(val * 255 / max);
+    }
+}
+
+static glyph_t *add_glyph(const lv_font_t *font, uint32_t letter)
+{
+    lv_font_glyph_dsc_t dsc;
+    if (!font->get_glyph_dsc(font, &dsc, letter, 0))
+        return NULL;
+
+    const uint8_t *src = font->get_glyph_bitmap(font, letter);
+    if (!src)
+        return NULL;
+
+    uint16_t size = dsc.box_w * dsc.box_h;
+    while (lru_tail && (stats.bytes + size > FONT_CACHE_SIZE))
+    {
+        remove_glyph(lru_tail);
+        stats.evictions++;
+    }
+
+    glyph_t *g = (glyph_t *)lv_mem_alloc(sizeof(glyph_t) - 1 + size);
+    if (!g)
+        return NULL;
+
+    g->font = font;
+    g->letter = letter;
+    g->size = size;
+    decode(src, dsc.bpp, g->bitmap, size);
+
+    uint32_t h = hash(font, letter);
+    g->hnext = buckets[h];
+    buckets[h] = g;
+    lru_push(g);
+    stats.bytes += size;
+    stats.glyphs++;
+    return g;
+}
+
+static inline bool is_cached_size(const lv_font_glyph_dsc_t *dsc)
+{
+    uint32_t size = dsc->box_w * dsc->box_h;
+    return (size > 0) && (size <= FONT_CACHE_MAX_GLYPH);
+}
+
+static bool has_kerning(const lv_font_t *font)
+{
+    if (font->get_glyph_dsc != lv_font_get_glyph_dsc_fmt_txt)
+        return true; // unknown format
+
+    const lv_font_fmt_txt_dsc_t *fdsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+    return (fdsc->kern_dsc != NULL);
+}
+
+static bool get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    wrap_t *w = (wrap_t *)font; // the slots are a cache, not part of the font
+    if (!w->kerning)
+        letter_next = 0;
+
+    dsc_slot_t *slot = &w->slots[(letter ^ (letter_next * 7)) & (FONT_CACHE_DSC_SLOTS - 1)];
+    if (letter && (slot->letter == letter) && (slot->letter_next == letter_next))
+    {
+        stats.dsc_hits++;
+        *dsc = slot->dsc;
+        return true;
+    }
+
+    stats.dsc_misses++;
+    if (!w->base->get_glyph_dsc(w->base, dsc, letter, letter_next))
+        return false;
+
+    if (is_cached_size(dsc))
+        dsc->bpp = 8;
+
+    slot->letter = letter;
+    slot->letter_next = letter_next;
+    slot->dsc = *dsc;
+    return true;
+}
+
+static const uint8_t *get_glyph_bitmap(const lv_font_t *font, uint32_t letter)
+{
+    const lv_font_t *base = ((const wrap_t *)font)->base;
+
+    glyph_t *g = find_glyph(base, letter);
+    if (g)
+    {
+        stats.hits++;
+        if (g != lru_head)
+        {
+            lru_unlink(g);
+            lru_push(g);
+        }
+        return g->bitmap;
+    }
+
+    // large glyphs are passed through, as reported by get_glyph_dsc
+    lv_font_glyph_dsc_t dsc;
+    if (!base->get_glyph_dsc(base, &dsc, letter, 0) || !is_cached_size(&dsc))
+        return base->get_glyph_bitmap(base, letter);
+
+    stats.misses++;
+    g = add_glyph(base, letter);
+    if (g)
+        return g->bitmap;
+
+    // out of memory: decode into a scratch buffer, valid until the next call
+    static uint8_t scratch[FONT_CACHE_MAX_GLYPH];
+    const uint8_t *src = base->get_glyph_bitmap(base, letter);
+    if (!src)
+        return NULL;
+    decode(src, dsc.bpp, scratch, dsc.box_w * dsc.box_h);
+    return scratch;
+}
+
+static void report_task_cb(lv_task_t *task)
+{
+    font_cache_report();
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+const lv_font_t *font_cache_wrap(const lv_font_t *font)
+{
+    if (!font || font->subpx)
+        return font;
+
+    for (uint16_t i = 0; i < num_wraps; i++)
+    {
+        if ((wraps[i].base == font) || (&wraps[i].font == font))
+            return &wraps[i].font;
+    }
+
+    if (num_wraps >= FONT_CACHE_MAX_FONTS)
+    {
+        MY_LOG("Font cache: too many fonts");
+        return font;
+    }
+
+    wrap_t *w = &wraps[num_wraps++];
+    w->font = *font;
+    w->font.get_glyph_dsc = get_glyph_dsc;
+    w->font.get_glyph_bitmap = get_glyph_bitmap;
+    w->base = font;
+    w->kerning = has_kerning(font);
+    memset(w->slots, 0, sizeof(w->slots));
+
+#if FONT_CACHE_REPORT_PERIOD
+    if (!report_task)
+    {
+        app_arena_begin(NULL); // outlives the screen being populated
+        report_task = lv_task_create(report_task_cb, FONT_CACHE_REPORT_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+        app_arena_end();
+    }
+#endif
+    return &w->font;
+}
+
+void font_cache_get_stats(font_cache_stats_t *stats_p)
+{
+    *stats_p = stats;
+}
+
+void font_cache_report(void)
+{
+    uint32_t lookups = stats.hits + stats.misses;
+    if (!lookups)
+        return;
+
+    MY_LOG("Font cache: %d glyphs, %d / %d bytes, %d hits, %d misses (%d%% hits), %d evictions",
+        stats.glyphs, stats.bytes, FONT_CACHE_SIZE, stats.hits, stats.misses,
+        stats.hits * 100 / lookups, stats.evictions);
+
+    uint32_t dsc_lookups = stats.dsc_hits + stats.dsc_misses;
+    if (dsc_lookups)
+        MY_LOG("Font cache: %d descriptor hits, %d misses (%d%% hits)",
+            stats.dsc_hits, stats.dsc_misses, stats.dsc_hits * 100 / dsc_lookups);
+}
+
+void font_cache_clear(void)
+{
+    while (lru_head)
+        remove_glyph(lru_head);
+
+    for (uint16_t i = 0; i < num_wraps; i++)
+        memset(wraps[i].slots, 0, sizeof(wraps[i].slots));
+
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.evictions = 0;
+    stats.dsc_hits = 0;
+    stats.dsc_misses = 0;
+}
+
+// ------------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------------
+
+#define BENCH_W    240
+#define BENCH_H    24
+#define BENCH_RUNS 100
+
+// time per lv_canvas_draw_text() in us, after one warm-up draw
+static uint32_t bench_draw(lv_obj_t *canvas, const lv_font_t *font, const char *txt, lv_bidi_dir_t dir)
+{
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = font;
+    dsc.bidi_dir = dir;
+
+    lv_canvas_draw_text(canvas, 0, 0, BENCH_W, &dsc, txt, LV_LABEL_ALIGN_LEFT);
+
+    uint32_t start = get_time_us();
+    for (uint16_t i = 0; i < BENCH_RUNS; i++)
+        lv_canvas_draw_text(canvas, 0, 0, BENCH_W, &dsc, txt, LV_LABEL_ALIGN_LEFT);
+    return (get_time_us() - start) / BENCH_RUNS;
+}
+
+void font_cache_bench(void)
+{
+    const struct
+    {
+        const char *name;
+        const lv_font_t *font;
+        const char *txt;
+        lv_bidi_dir_t dir;
+    } tests[] = {
+        { "Latin", &lv_font_montserrat_16, "Dienstag, 22.09.2020 08:19:48", LV_BIDI_DIR_LTR },
+        // Chinese: hello world, today is Tuesday
+#if LV_FONT_SIMSUN_16_CJK
+        { "CJK", &lv_font_simsun_16_cjk,
+#else
+        { "CJK", font_lazy_create(FONT_LAZY_PATH_CJK), // NULL if the file is missing
+#endif
+          "\xe4\xbd\xa0\xe5\xa5\xbd\xe4\xb8\x96\xe7\x95\x8c\xef\xbc\x8c\xe4\xbb\x8a\xe5\xa4\xa9"
+          "\xe6\x98\xaf\xe6\x98\x9f\xe6\x9c\x9f\xe4\xba\x8c", LV_BIDI_DIR_LTR },
+        // Arabic: hello world, eight o'clock
+#if LV_FONT_DEJAVU_16_PERSIAN_HEBREW
+        { "Arabic", &lv_font_dejavu_16_persian_hebrew,
+#else
+        { "Arabic", font_lazy_create(FONT_LAZY_PATH_PERSIAN_HEBREW), // NULL if the file is missing
+#endif
+          "\xd9\x85\xd8\xb1\xd8\xad\xd8\xa8\xd8\xa7\x20\xd8\xa8\xd8\xa7\xd9\x84\xd8\xb9\xd8\xa7\xd9\x84"
+          "\xd9\x85\xd8\x8c\x20\xd8\xa7\xd9\x84\xd8\xb3\xd8\xa7\xd8\xb9\xd8\xa9\x20\xd8\xa7\xd9\x84"
+          "\xd8\xab\xd8\xa7\xd9\x85\xd9\x86\xd8\xa9", LV_BIDI_DIR_RTL },
+    };
+
+    void *buf = lv_mem_alloc(LV_CANVAS_BUF_SIZE_TRUE_COLOR(BENCH_W, BENCH_H));
+    if (!buf)
+    {
+        MY_LOG("Font bench: out of memory");
+        return;
+    }
+
+    lv_obj_t *scr = lv_obj_create(NULL, NULL); // not loaded
+    lv_obj_t *canvas = lv_canvas_create(scr, NULL);
+    lv_canvas_set_buffer(canvas, buf, BENCH_W, BENCH_H, LV_IMG_CF_TRUE_COLOR);
+    lv_canvas_fill_bg(canvas, LV_COLOR_WHITE, LV_OPA_COVER);
+
+    MY_LOG("Font bench: us per draw of %d px text (%d runs)", BENCH_W, BENCH_RUNS);
+    for (uint16_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+    {
+        if (!tests[i].font)
+            continue; // font file missing
+
+        const char *txt = tests[i].txt;
+#if LV_USE_ARABIC_PERSIAN_CHARS
+        // as lv_label does: replace the letters by their contextual forms
+        static char shaped[256];
+        if (_lv_txt_ap_calc_bytecnt(txt) < sizeof(shaped))
+        {
+            _lv_txt_ap_proc(txt, shaped);
+            txt = shaped;
+        }
+#endif
+        uint32_t before = bench_draw(canvas, tests[i].font, txt, tests[i].dir);
+        uint32_t after  = bench_draw(canvas, font_cache_wrap(tests[i].font), txt, tests[i].dir);
+        MY_LOG("  %-8s unwrapped %5d us, wrapped %5d us", tests[i].name, before, after);
+    }
+    font_cache_report();
+    font_lazy_report();
+
+    lv_obj_del(scr);
+    lv_mem_free(buf);
+}
+
+#endif // USE_FONT_CACHE
+
+// ------------------------------------------------------------------------
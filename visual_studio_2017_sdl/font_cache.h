@@ -0,0 +1,68 @@
+// ------------------------------------------------------------------------
+// Glyph descriptor and bitmap cache
+// ------------------------------------------------------------------------
+
+#ifndef __FONT_CACHE_H__
+#define __FONT_CACHE_H__
+
+// 1: look up glyph descriptors of wrapped fonts in a direct-mapped table,
+//    keep their decoded A8 bitmaps in an LRU cache
+#ifndef USE_FONT_CACHE
+#define USE_FONT_CACHE 1
+#endif
+
+// The bitmaps are allocated by lv_mem. The hot glyphs are the clock digits
+// of lv_font_montserrat_48 (BaseTile::style_time): boxes up to ~27x34, so
+// the 11 glyphs of "0".."9" and ":" take ~9 KB as A8. 12 KB of the 64 KB
+// heap keep them resident next to the text of a screen (~130 bytes per
+// glyph at 16 px). Larger glyphs are drawn from the font directly.
+#define FONT_CACHE_SIZE          (LV_MEM_SIZE * 3 / 16) // byte budget of the bitmaps, 12 KB
+#define FONT_CACHE_MAX_GLYPH     1536                   // above the 48 px digit box
+#define FONT_CACHE_MAX_FONTS     8
+#define FONT_CACHE_DSC_SLOTS     64            // per font, power of 2
+#define FONT_CACHE_REPORT_PERIOD 0             // ms, 0: no periodic report
+
+#if USE_FONT_CACHE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t dsc_hits;
+    uint32_t dsc_misses;
+    uint32_t bytes;   // currently cached
+    uint16_t glyphs;  // currently cached
+} font_cache_stats_t;
+
+// Return a font drawing from the cache, to be used instead of font.
+// Subpixel fonts and fonts beyond FONT_CACHE_MAX_FONTS are returned unchanged.
+const lv_font_t *font_cache_wrap(const lv_font_t *font);
+
+void font_cache_get_stats(font_cache_stats_t *stats);
+void font_cache_report(void);
+void font_cache_clear(void);
+
+// log the label draw time of Latin, CJK and Arabic text, unwrapped vs. wrapped
+void font_cache_bench(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define font_cache_wrap(font) (font)
+#define font_cache_report()
+#define font_cache_clear()
+#define font_cache_bench()
+
+#endif // USE_FONT_CACHE
+
+#endif // __FONT_CACHE_H__
+
+// ------------------------------------------------------------------------
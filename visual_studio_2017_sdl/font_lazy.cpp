@@ -0,0 +1,688 @@
+// ------------------------------------------------------------------------
+// Lazy-loaded fonts from binary font files
+// ------------------------------------------------------------------------
+//
+// A built-in font is a const array linked into the binary, a font loaded by
+// lv_font_load() is read into RAM as a whole. The CJK and Persian/Hebrew
+// fonts are rarely shown by the watch, so here they stay in their binary
+// font files (lv_font_conv --format bin):
+//
+// - creating a font reads its header only (line height and base line)
+// - the first glyph lookup loads the character map, the glyph offsets
+//   (loca) and the kerning, and keeps the file open
+// - each glyph is read from the file when looked up, and kept in an LRU
+//   list of FONT_LAZY_CACHE_SIZE bytes per font
+// - fonts not used for FONT_LAZY_IDLE_TIME, or all fonts when lv_mem runs
+//   low, are unloaded back to their header
+//
+// The files are read through lv_fs, with a stdio driver on drive 'P'.
+// Compressed fonts and fonts with 3 bpp are not supported, convert them
+// with --no-compress and --bpp 4.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "font_lazy.h"
+#include "app_arena.h"
+#include "tlsf_mem.h"
+
+#if USE_FONT_LAZY
+
+#include <stdio.h>
+
+#define GLYPH_SLOTS 32 // direct-mapped index of the paged-in glyphs, power of 2
+
+// sections of the binary font format, each one starts with its length
+// (uint32_t, including this label) and its tag
+#define LABEL_SIZE 8
+
+typedef struct
+{
+    uint32_t version;
+    uint16_t tables_count;
+    uint16_t font_size;
+    uint16_t ascent;
+    int16_t descent;
+    uint16_t typo_ascent;
+    int16_t typo_descent;
+    uint16_t typo_line_gap;
+    int16_t min_y;
+    int16_t max_y;
+    uint16_t default_advance_width;
+    uint16_t kerning_scale;            // FP12.4
+    uint8_t index_to_loc_format;       // 0: uint16_t offsets, 1: uint32_t
+    uint8_t glyph_id_format;           // 0: uint8_t ids in kerning pairs, 1: uint16_t
+    uint8_t advance_width_format;      // 0: integer, 1: FP12.4
+    uint8_t bits_per_pixel;
+    uint8_t xy_bits;
+    uint8_t wh_bits;
+    uint8_t advance_width_bits;
+    uint8_t compression_id;
+    uint8_t subpixels_mode;
+    uint8_t padding;
+} head_t;
+
+typedef struct
+{
+    uint32_t data_offset;              // from the start of the cmap section
+    uint32_t range_start;
+    uint16_t range_length;
+    uint16_t glyph_id_start;
+    uint16_t data_entries_count;
+    uint8_t format_type;               // as lv_font_fmt_txt_cmap_type_t
+    uint8_t padding;
+} cmap_t;
+
+enum { CMAP_FORMAT0_FULL, CMAP_SPARSE_FULL, CMAP_FORMAT0_TINY, CMAP_SPARSE_TINY };
+
+typedef struct _glyph_t
+{
+    struct _glyph_t *prev, *next;      // LRU list, most recent first
+    uint32_t gid;
+    int32_t adv_w;                     // FP12.4, without kerning
+    lv_font_glyph_dsc_t dsc;
+    uint16_t size;                     // of bitmap
+    uint8_t bitmap[1];                 // as in the file, rows are not padded
+} glyph_t;
+
+typedef struct
+{
+    lv_font_t font;                    // handed out
+    char path[FONT_LAZY_PATH_LEN];
+    head_t head;
+    uint32_t head_len;
+    bool failed;                       // do not retry loading
+
+    // loaded on first use
+    bool loaded;
+    lv_fs_file_t file;
+    uint8_t *cmap;                     // whole sections, with their label
+    uint8_t *loca;
+    uint8_t *kern;                     // NULL: no kerning
+    uint32_t num_glyphs;
+    uint32_t glyf_start, glyf_len;
+    uint32_t table_bytes;
+
+    glyph_t *slots[GLYPH_SLOTS];
+    glyph_t *lru_head, *lru_tail;
+    uint32_t glyph_bytes;
+    uint32_t last_letter;              // of get_glyph_dsc, for get_glyph_bitmap
+    glyph_t *last_glyph;
+    uint32_t last_used;                // tick
+} lazy_font_t;
+
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t bit;
+} bit_reader_t;
+
+static lazy_font_t fonts[FONT_LAZY_MAX_FONTS];
+static font_lazy_stats_t stats;
+
+static lv_task_t *check_task;
+
+// ------------------------------------------------------------------------
+// PC file system driver
+// ------------------------------------------------------------------------
+
+static lv_fs_res_t pc_open(lv_fs_drv_t *drv, void *file_p, const char *path, lv_fs_mode_t mode)
+{
+    const char *flags = (mode == LV_FS_MODE_WR) ? "wb" : (mode == LV_FS_MODE_RD) ? "rb" : "rb+";
+    FILE *fp = fopen(path, flags);
+    if (!fp)
+        return LV_FS_RES_NOT_EX;
+
+    *(FILE **)file_p = fp;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t pc_close(lv_fs_drv_t *drv, void *file_p)
+{
+    fclose(*(FILE **)file_p);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t pc_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
+{
+    *br = (uint32_t)fread(buf, 1, btr, *(FILE **)file_p);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t pc_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos)
+{
+    return fseek(*(FILE **)file_p, pos, SEEK_SET) ? LV_FS_RES_FS_ERR : LV_FS_RES_OK;
+}
+
+static lv_fs_res_t pc_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
+{
+    *pos_p = (uint32_t)ftell(*(FILE **)file_p);
+    return LV_FS_RES_OK;
+}
+
+static void pc_fs_init(void)
+{
+    if (lv_fs_get_drv(FONT_LAZY_FS_LETTER))
+        return;
+
+    static lv_fs_drv_t drv;
+    lv_fs_drv_init(&drv);
+    drv.letter = FONT_LAZY_FS_LETTER;
+    drv.file_size = sizeof(FILE *);
+    drv.open_cb = pc_open;
+    drv.close_cb = pc_close;
+    drv.read_cb = pc_read;
+    drv.seek_cb = pc_seek;
+    drv.tell_cb = pc_tell;
+    lv_fs_drv_register(&drv);
+}
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static bool read_at(lazy_font_t *lf, uint32_t pos, void *buf, uint32_t len)
+{
+    uint32_t br;
+    return (lv_fs_seek(&lf->file, pos) == LV_FS_RES_OK)
+        && (lv_fs_read(&lf->file, buf, len, &br) == LV_FS_RES_OK)
+        && (br == len);
+}
+
+// return the length of the section at pos, 0 if it is not tag
+static uint32_t read_label(lazy_font_t *lf, uint32_t pos, const char *tag)
+{
+    uint32_t label[2];
+    if (!read_at(lf, pos, label, sizeof(label)) || memcmp(&label[1], tag, 4))
+        return 0;
+    return label[0];
+}
+
+// read the section at pos into lv_mem, with its label
+static uint8_t *read_section(lazy_font_t *lf, uint32_t pos, const char *tag, uint32_t *len)
+{
+    *len = read_label(lf, pos, tag);
+    if (*len <= LABEL_SIZE)
+        return NULL;
+
+    uint8_t *data = (uint8_t *)lv_mem_alloc(*len);
+    if (!data)
+        return NULL;
+
+    if (!read_at(lf, pos, data, *len))
+    {
+        lv_mem_free(data);
+        return NULL;
+    }
+
+    lf->table_bytes += *len;
+    stats.bytes += *len;
+    return data;
+}
+
+static uint32_t read_bits(bit_reader_t *br, uint8_t num)
+{
+    uint32_t val = 0;
+    for (; num; num--, br->bit++)
+        val = (val << 1) | ((br->data[br->bit >> 3] >> (7 - (br->bit & 7))) & 1);
+    return val;
+}
+
+static int32_t read_bits_signed(bit_reader_t *br, uint8_t num)
+{
+    uint32_t val = read_bits(br, num);
+    if (num && (val & (1U << (num - 1))))
+        val |= ~0U << num; // sign extend
+    return (int32_t)val;
+}
+
+static void lru_unlink(lazy_font_t *lf, glyph_t *g)
+{
+    if (g->prev)
+        g->prev->next = g->next;
+    else
+        lf->lru_head = g->next;
+    if (g->next)
+        g->next->prev = g->prev;
+    else
+        lf->lru_tail = g->prev;
+}
+
+static void lru_push(lazy_font_t *lf, glyph_t *g)
+{
+    g->prev = NULL;
+    g->next = lf->lru_head;
+    if (lf->lru_head)
+        lf->lru_head->prev = g;
+    lf->lru_head = g;
+    if (!lf->lru_tail)
+        lf->lru_tail = g;
+}
+
+static void remove_glyph(lazy_font_t *lf, glyph_t *g)
+{
+    glyph_t **slot = &lf->slots[g->gid & (GLYPH_SLOTS - 1)];
+    if (*slot == g)
+        *slot = NULL;
+    if (lf->last_glyph == g)
+        lf->last_glyph = NULL;
+
+    lru_unlink(lf, g);
+    uint32_t size = sizeof(glyph_t) - 1 + g->size;
+    lf->glyph_bytes -= size;
+    stats.bytes -= size;
+    lv_mem_free(g);
+}
+
+static void unload(lazy_font_t *lf)
+{
+    if (!lf->loaded)
+        return;
+
+    while (lf->lru_head)
+        remove_glyph(lf, lf->lru_head);
+
+    lv_mem_free(lf->cmap);
+    lv_mem_free(lf->loca);
+    if (lf->kern)
+        lv_mem_free(lf->kern);
+    lf->cmap = lf->loca = lf->kern = NULL;
+    stats.bytes -= lf->table_bytes;
+    lf->table_bytes = 0;
+
+    lv_fs_close(&lf->file);
+    lf->loaded = false;
+    stats.loaded--;
+    stats.unloads++;
+}
+
+static bool load(lazy_font_t *lf)
+{
+    if (lv_fs_open(&lf->file, lf->path, LV_FS_MODE_RD) != LV_FS_RES_OK)
+        return false;
+
+    lf->loaded = true;
+    stats.loaded++;
+    stats.loads++;
+
+    uint32_t cmap_len = 0, loca_len = 0, kern_len = 0;
+    lf->cmap = read_section(lf, lf->head_len, "cmap", &cmap_len);
+    lf->loca = read_section(lf, lf->head_len + cmap_len, "loca", &loca_len);
+    lf->glyf_start = lf->head_len + cmap_len + loca_len;
+    lf->glyf_len = read_label(lf, lf->glyf_start, "glyf");
+    if (lf->head.tables_count > 3)
+        lf->kern = read_section(lf, lf->glyf_start + lf->glyf_len, "kern", &kern_len);
+
+    if (!lf->cmap || !lf->loca || !lf->glyf_len)
+    {
+        unload(lf);
+        return false;
+    }
+
+    lf->num_glyphs = *(const uint32_t *)(lf->loca + LABEL_SIZE);
+    lf->last_glyph = NULL;
+    MY_LOG("Font %s: loaded, %d glyphs, %d bytes of tables", lf->path, lf->num_glyphs, lf->table_bytes);
+    return true;
+}
+
+// load the font if not yet loaded, return false if it cannot be loaded
+static bool use(lazy_font_t *lf)
+{
+    lf->last_used = lv_tick_get();
+    if (lf->loaded)
+        return true;
+    if (lf->failed)
+        return false;
+
+    if (load(lf))
+        return true;
+
+    MY_LOG("Font %s: cannot be loaded", lf->path);
+    lf->failed = true;
+    return false;
+}
+
+// glyph id of letter, 0: none
+static uint32_t get_gid(const lazy_font_t *lf, uint32_t letter)
+{
+    uint32_t num_cmaps = *(const uint32_t *)(lf->cmap + LABEL_SIZE);
+    const cmap_t *cmaps = (const cmap_t *)(lf->cmap + LABEL_SIZE + 4);
+
+    for (uint32_t i = 0; i < num_cmaps; i++)
+    {
+        const cmap_t *c = &cmaps[i];
+        if ((letter < c->range_start) || (letter - c->range_start >= c->range_length))
+            continue;
+
+        uint32_t rcp = letter - c->range_start;
+        const uint8_t *data = lf->cmap + c->data_offset;
+
+        if (c->format_type == CMAP_FORMAT0_TINY)
+            return c->glyph_id_start + rcp;
+        if (c->format_type == CMAP_FORMAT0_FULL)
+            return c->glyph_id_start + data[rcp];
+
+        // sparse: binary search in the sorted code points (relative to range_start)
+        const uint16_t *list = (const uint16_t *)data;
+        uint32_t lo = 0, hi = c->data_entries_count;
+        while (lo < hi)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            if (list[mid] < rcp)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if ((lo == c->data_entries_count) || (list[lo] != rcp))
+            continue;
+
+        if (c->format_type == CMAP_SPARSE_TINY)
+            return c->glyph_id_start + lo;
+        return c->glyph_id_start + list[c->data_entries_count + lo]; // glyph id offsets follow the code points
+    }
+    return 0;
+}
+
+static uint32_t get_offset(const lazy_font_t *lf, uint32_t gid)
+{
+    if (gid >= lf->num_glyphs)
+        return lf->glyf_len;
+
+    const uint8_t *offsets = lf->loca + LABEL_SIZE + 4;
+    if (lf->head.index_to_loc_format)
+        return ((const uint32_t *)offsets)[gid];
+    return ((const uint16_t *)offsets)[gid];
+}
+
+// kerning in font units, formats as lv_font_fmt_txt: sorted glyph id pairs (0) or classes (3)
+static int8_t get_kern(const lazy_font_t *lf, uint32_t gid_left, uint32_t gid_right)
+{
+    const uint8_t *p = lf->kern + LABEL_SIZE;
+    uint8_t format = p[0];
+    p += 4; // format, padding
+
+    if (format == 0)
+    {
+        uint32_t num_pairs = *(const uint32_t *)p;
+        const uint8_t *ids = p + 4;
+        bool wide = (lf->head.glyph_id_format != 0);
+        const int8_t *values = (const int8_t *)(ids + num_pairs * (wide ? 4 : 2));
+
+        uint32_t lo = 0, hi = num_pairs;
+        while (lo < hi)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            uint32_t left  = wide ? ((const uint16_t *)ids)[2 * mid]     : ids[2 * mid];
+            uint32_t right = wide ? ((const uint16_t *)ids)[2 * mid + 1] : ids[2 * mid + 1];
+            if ((left == gid_left) && (right == gid_right))
+                return values[mid];
+            if ((left < gid_left) || ((left == gid_left) && (right < gid_right)))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return 0;
+    }
+
+    if (format == 3)
+    {
+        uint16_t map_len = *(const uint16_t *)p;
+        uint8_t rows = p[2], cols = p[3];
+        const uint8_t *left = p + 4;
+        const uint8_t *right = left + map_len;
+        const int8_t *values = (const int8_t *)(right + map_len);
+        if ((gid_left >= map_len) || (gid_right >= map_len))
+            return 0;
+
+        uint8_t left_class = left[gid_left], right_class = right[gid_right];
+        if (!left_class || !right_class || (left_class > rows) || (right_class > cols))
+            return 0;
+        return values[(left_class - 1) * cols + (right_class - 1)];
+    }
+
+    return 0;
+}
+
+static glyph_t *page_in(lazy_font_t *lf, uint32_t gid)
+{
+    uint32_t start = get_offset(lf, gid);
+    uint32_t len = get_offset(lf, gid + 1) - start;
+    if (!len || (len > FONT_LAZY_MAX_RECORD))
+        return NULL;
+
+    static uint8_t record[FONT_LAZY_MAX_RECORD];
+    if (!read_at(lf, lf->glyf_start + start, record, len))
+        return NULL;
+
+    // bit packed: advance width, x and y offset, width, height, bitmap
+    const head_t *h = &lf->head;
+    bit_reader_t br = { record, 0 };
+    int32_t adv_w = h->advance_width_bits ? read_bits(&br, h->advance_width_bits) : h->default_advance_width;
+    if (h->advance_width_format == 0)
+        adv_w <<= 4; // to FP12.4
+    int32_t ofs_x = read_bits_signed(&br, h->xy_bits);
+    int32_t ofs_y = read_bits_signed(&br, h->xy_bits);
+    uint32_t box_w = read_bits(&br, h->wh_bits);
+    uint32_t box_h = read_bits(&br, h->wh_bits);
+
+    uint32_t bitmap_bits = h->bits_per_pixel * box_w * box_h;
+    if (br.bit + bitmap_bits > len * 8)
+        return NULL;
+
+    uint16_t size = (uint16_t)((bitmap_bits + 7) / 8);
+    uint32_t alloc = sizeof(glyph_t) - 1 + size;
+    while (lf->lru_tail && (lf->glyph_bytes + alloc > FONT_LAZY_CACHE_SIZE))
+    {
+        remove_glyph(lf, lf->lru_tail);
+        stats.evictions++;
+    }
+
+    glyph_t *g = (glyph_t *)lv_mem_alloc(alloc);
+    if (!g)
+        return NULL;
+
+    g->gid = gid;
+    g->adv_w = adv_w;
+    g->dsc.adv_w = 0; // with kerning, see get_glyph_dsc
+    g->dsc.box_w = (uint16_t)box_w;
+    g->dsc.box_h = (uint16_t)box_h;
+    g->dsc.ofs_x = (int16_t)ofs_x;
+    g->dsc.ofs_y = (int16_t)ofs_y;
+    g->dsc.bpp = h->bits_per_pixel;
+    g->size = size;
+
+    // the bitmap is not byte aligned in the file
+    for (uint16_t i = 0; i < size; i++)
+    {
+        uint8_t num = (uint8_t)LV_MATH_MIN(8U, bitmap_bits - i * 8U);
+        g->bitmap[i] = (uint8_t)(read_bits(&br, num) << (8 - num));
+    }
+
+    lru_push(lf, g);
+    lf->glyph_bytes += alloc;
+    stats.bytes += alloc;
+    stats.page_ins++;
+    return g;
+}
+
+static glyph_t *get_glyph(lazy_font_t *lf, uint32_t gid)
+{
+    glyph_t **slot = &lf->slots[gid & (GLYPH_SLOTS - 1)];
+    glyph_t *g = *slot;
+    if (!g || (g->gid != gid))
+    {
+        for (g = lf->lru_head; g && (g->gid != gid); g = g->next)
+            ;
+        if (!g)
+            g = page_in(lf, gid);
+        else
+            stats.hits++;
+        if (!g)
+            return NULL;
+        *slot = g;
+    }
+    else
+        stats.hits++;
+
+    if (g != lf->lru_head)
+    {
+        lru_unlink(lf, g);
+        lru_push(lf, g);
+    }
+    return g;
+}
+
+static bool get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    lazy_font_t *lf = (lazy_font_t *)font->dsc;
+    if (!use(lf))
+        return false;
+
+    uint32_t gid = get_gid(lf, letter);
+    glyph_t *g = gid ? get_glyph(lf, gid) : NULL;
+    if (!g)
+        return false;
+
+    int32_t adv_w = g->adv_w;
+    if (lf->kern && letter_next)
+    {
+        uint32_t gid_next = get_gid(lf, letter_next);
+        if (gid_next)
+            adv_w += (get_kern(lf, gid, gid_next) * (int32_t)lf->head.kerning_scale) >> 4;
+    }
+
+    *dsc = g->dsc;
+    dsc->adv_w = (uint16_t)((adv_w + (1 << 3)) >> 4);
+
+    lf->last_letter = letter;
+    lf->last_glyph = g;
+    return true;
+}
+
+static const uint8_t *get_glyph_bitmap(const lv_font_t *font, uint32_t letter)
+{
+    lazy_font_t *lf = (lazy_font_t *)font->dsc;
+
+    // usually right after get_glyph_dsc of the same letter
+    if (lf->last_glyph && (lf->last_letter == letter))
+        return lf->last_glyph->bitmap;
+
+    if (!use(lf))
+        return NULL;
+
+    uint32_t gid = get_gid(lf, letter);
+    glyph_t *g = gid ? get_glyph(lf, gid) : NULL;
+    return g ? g->bitmap : NULL;
+}
+
+static void check_task_cb(lv_task_t *task)
+{
+    lv_mem_monitor_t mon;
+    mem_monitor(&mon);
+    bool low_mem = (mon.free_size < FONT_LAZY_MIN_FREE);
+
+    for (uint16_t i = 0; i < stats.fonts; i++)
+    {
+        lazy_font_t *lf = &fonts[i];
+        if (!lf->loaded)
+            continue;
+
+        bool idle = FONT_LAZY_IDLE_TIME && (lv_tick_elaps(lf->last_used) > FONT_LAZY_IDLE_TIME);
+        if (low_mem || idle)
+        {
+            MY_LOG("Font %s: unloaded (%s)", lf->path, low_mem ? "low memory" : "idle");
+            unload(lf);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+const lv_font_t *font_lazy_create(const char *path)
+{
+    for (uint16_t i = 0; i < stats.fonts; i++)
+    {
+        if (!strcmp(fonts[i].path, path))
+            return &fonts[i].font;
+    }
+
+    if ((stats.fonts >= FONT_LAZY_MAX_FONTS) || (strlen(path) >= FONT_LAZY_PATH_LEN))
+    {
+        MY_LOG("Font %s: too many fonts or path too long", path);
+        return NULL;
+    }
+
+    pc_fs_init();
+
+    lazy_font_t *lf = &fonts[stats.fonts];
+    memset(lf, 0, sizeof(lazy_font_t));
+    strcpy(lf->path, path);
+
+    if (lv_fs_open(&lf->file, path, LV_FS_MODE_RD) != LV_FS_RES_OK)
+    {
+        MY_LOG("Font %s: not found", path);
+        return NULL;
+    }
+    lf->head_len = read_label(lf, 0, "head");
+    bool ok = (lf->head_len >= LABEL_SIZE + sizeof(head_t)) && read_at(lf, LABEL_SIZE, &lf->head, sizeof(head_t));
+    lv_fs_close(&lf->file);
+
+    if (!ok || lf->head.compression_id || (lf->head.bits_per_pixel == 3))
+    {
+        MY_LOG("Font %s: invalid, compressed or 3 bpp", path);
+        return NULL;
+    }
+
+    lv_font_t *font = &lf->font;
+    font->get_glyph_dsc = get_glyph_dsc;
+    font->get_glyph_bitmap = get_glyph_bitmap;
+    font->line_height = lf->head.ascent - lf->head.descent;
+    font->base_line = -lf->head.descent;
+    font->subpx = lf->head.subpixels_mode;
+    font->dsc = lf;
+    stats.fonts++;
+
+    if (!check_task)
+    {
+        app_arena_begin(NULL); // outlives the screen being populated
+        check_task = lv_task_create(check_task_cb, FONT_LAZY_CHECK_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+        app_arena_end();
+    }
+    return font;
+}
+
+void font_lazy_unload(const lv_font_t *font)
+{
+    if (font && (font->get_glyph_dsc == get_glyph_dsc))
+        unload((lazy_font_t *)font->dsc);
+}
+
+void font_lazy_unload_all(void)
+{
+    for (uint16_t i = 0; i < stats.fonts; i++)
+        unload(&fonts[i]);
+}
+
+void font_lazy_get_stats(font_lazy_stats_t *stats_p)
+{
+    *stats_p = stats;
+}
+
+void font_lazy_report(void)
+{
+    MY_LOG("Lazy fonts: %d of %d loaded, %d bytes resident, %d loads, %d unloads",
+        stats.loaded, stats.fonts, stats.bytes, stats.loads, stats.unloads);
+    MY_LOG("Lazy fonts: %d glyphs paged in, %d hits, %d evictions", stats.page_ins, stats.hits, stats.evictions);
+
+    for (uint16_t i = 0; i < stats.fonts; i++)
+    {
+        const lazy_font_t *lf = &fonts[i];
+        if (lf->loaded)
+            MY_LOG("  %s: %d bytes of tables, %d bytes of glyphs", lf->path, lf->table_bytes, lf->glyph_bytes);
+    }
+}
+
+#endif // USE_FONT_LAZY
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,73 @@
+// ------------------------------------------------------------------------
+// Lazy-loaded fonts from binary font files
+// ------------------------------------------------------------------------
+
+#ifndef __FONT_LAZY_H__
+#define __FONT_LAZY_H__
+
+// 1: load rarely used fonts from LVGL binary font files (lv_font_conv --format bin)
+//    on first use, page in their glyphs on demand
+#ifndef USE_FONT_LAZY
+#define USE_FONT_LAZY 1
+#endif
+
+#define FONT_LAZY_FS_LETTER    'P'           // drive of the PC file system driver
+#define FONT_LAZY_MAX_FONTS    4
+#define FONT_LAZY_PATH_LEN     64
+#define FONT_LAZY_CACHE_SIZE   (8U * 1024U)  // per font: byte budget of the paged-in glyphs (allocated by lv_mem)
+#define FONT_LAZY_MAX_RECORD   1024          // bytes of a glyph in the file, larger glyphs are not drawn
+#define FONT_LAZY_IDLE_TIME    30000         // ms, unload fonts not used for so long, 0: never
+#define FONT_LAZY_MIN_FREE     (8U * 1024U)  // unload all fonts if lv_mem has less free
+#define FONT_LAZY_CHECK_PERIOD 1000          // ms
+
+// converted from the fonts of lvgl/src/lv_font with
+//   lv_font_conv --no-compress --bpp 4 --size 16 --format bin --font <TTF> -r <ranges> -o <file>
+#define FONT_LAZY_PATH_CJK            "P:fonts/simsun_16_cjk.bin"
+#define FONT_LAZY_PATH_PERSIAN_HEBREW "P:fonts/dejavu_16_persian_hebrew.bin"
+
+#if USE_FONT_LAZY
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t loads;
+    uint32_t unloads;
+    uint32_t page_ins;  // glyphs read from file
+    uint32_t hits;      // glyphs found in memory
+    uint32_t evictions;
+    uint32_t bytes;     // currently resident: tables and glyphs
+    uint16_t fonts;     // created
+    uint16_t loaded;    // currently loaded
+} font_lazy_stats_t;
+
+// Return a font reading from path (e.g. FONT_LAZY_PATH_CJK), or NULL if it
+// cannot be read. Only the header is read here; the character map and the
+// kerning are loaded on first use, the glyphs when drawn.
+const lv_font_t *font_lazy_create(const char *path);
+
+// free everything but the header, reloaded on next use
+void font_lazy_unload(const lv_font_t *font);
+void font_lazy_unload_all(void);
+
+void font_lazy_get_stats(font_lazy_stats_t *stats);
+void font_lazy_report(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define font_lazy_create(path) ((const lv_font_t *)NULL)
+#define font_lazy_unload(font)
+#define font_lazy_unload_all()
+#define font_lazy_report()
+
+#endif // USE_FONT_LAZY
+
+#endif // __FONT_LAZY_H__
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,529 @@
+#!/usr/bin/env python3
+# ------------------------------------------------------------------------
+# Usage-driven font subsetting for the watch build profile
+# ------------------------------------------------------------------------
+"""
+Collects the fonts and code points referenced by the app sources and their
+string tables, generates subsetted fonts with lv_font_conv and reports the
+flash saved and the glyphs which could be missing at runtime.
+
+Usage (from visual_studio_2017_sdl, lv_font_conv: npm i -g lv_font_conv):
+
+    python fonts/font_subset.py                       report only (dry run)
+    python fonts/font_subset.py --ttf Montserrat-Medium.ttf
+                                --symbols FontAwesome5-Solid+Brands+Regular.woff
+
+The TTF/WOFF files are the ones the LVGL built-in fonts were made from
+(see lvgl/scripts/built_in_font). Generated files in fonts/:
+
+    watch_montserrat_<size>.c   subsetted fonts
+    watch_fonts.inc             included by watch_fonts.c
+    watch_fonts_conf.h          included by lv_conf.h if LV_WATCH_PROFILE is 1:
+                                disables the built-in fonts and maps their
+                                names (lv_font_montserrat_<size>) to the subsets
+
+Text which is only known at runtime (e.g. "%s" arguments, lv_label_set_text
+with a variable) cannot be checked; these sites are listed in the report.
+Printable ASCII is always kept for them, unless --no-ascii is given.
+
+Not scanned: benchmarks (*_bench.* files and functions named *bench*) and
+blocks disabled by the preprocessor (#if 0, #if USE_xxx defined as 0 in
+lv_conf.h or the app headers).
+"""
+
+import argparse
+import glob
+import os
+import re
+import subprocess
+import sys
+
+APP_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+OUT_DIR = os.path.join(APP_DIR, 'fonts')
+LVGL_FONT_DIR = os.path.join(APP_DIR, 'lvgl', 'src', 'lv_font')
+SYMBOL_DEF = os.path.join(LVGL_FONT_DIR, 'lv_symbol_def.h')
+LV_CONF = os.path.join(APP_DIR, 'lv_conf.h')
+
+# built-in fonts which can be enabled in lv_conf.h: name -> config define
+BUILTIN_FONTS = {}
+for size in range(12, 50, 2):
+    BUILTIN_FONTS['montserrat_%d' % size] = 'LV_FONT_MONTSERRAT_%d' % size
+BUILTIN_FONTS.update({
+    'montserrat_12_subpx': 'LV_FONT_MONTSERRAT_12_SUBPX',
+    'montserrat_28_compressed': 'LV_FONT_MONTSERRAT_28_COMPRESSED',
+    'dejavu_16_persian_hebrew': 'LV_FONT_DEJAVU_16_PERSIAN_HEBREW',
+    'simsun_16_cjk': 'LV_FONT_SIMSUN_16_CJK',
+    'unscii_8': 'LV_FONT_UNSCII_8',
+})
+
+# ranges of the built-in Montserrat fonts (besides the symbols)
+BUILTIN_RANGES = [(0x20, 0x7F), (0xB0, 0xB0), (0x2022, 0x2022)]
+
+# ranges of the built-in fonts which are kept as they are (not subsetted)
+KEPT_RANGES = {
+    'simsun_16_cjk': [(0x3000, 0x303F), (0x4E00, 0x9FFF), (0xFF00, 0xFFEF)],
+    'dejavu_16_persian_hebrew': [(0x0590, 0x06FF), (0xFB1D, 0xFEFF)],
+}
+
+# code points of the kept fonts, never added to a Montserrat subset
+KEPT_CPS = set()
+for _ranges in KEPT_RANGES.values():
+    for _lo, _hi in _ranges:
+        KEPT_CPS |= set(range(_lo, _hi + 1))
+
+ASCII = set(range(0x20, 0x7F))
+DIGITS = set(ord(c) for c in '0123456789-')
+
+FONT_RE = re.compile(r'\blv_font_(%s)\b' % '|'.join(sorted(BUILTIN_FONTS, key=len, reverse=True)))
+THEME_FONT_RE = re.compile(r'\blv_theme_get_font_(small|normal|subtitle|title)\b')
+SYMBOL_RE = re.compile(r'\bLV_SYMBOL_\w+\b')
+LOG_RE = re.compile(r'\b(MY_LOG|printf|fprintf|Serial\.printf|LV_LOG_\w+)\s*\(')
+BENCH_FUNC_RE = re.compile(r'\b\w*bench\w*\s*\([^;{}()]*\)\s*\{')
+DEFINE_RE = re.compile(r'^[ \t]*#[ \t]*define[ \t]+(\w+)[ \t]+\(?(\d+)U?\)?[ \t]*(?://.*|/\*.*)?$', re.M)
+DYN_TEXT_RE = re.compile(r'\b(lv_label_set_text|lv_label_set_static_text|lv_list_add_btn)\s*\(([^;]*)\)\s*;')
+
+# element sizes of the font data (32 bit target)
+ELEM_SIZE = {
+    'uint8_t': 1, 'int8_t': 1, 'uint16_t': 2, 'int16_t': 2, 'uint32_t': 4,
+    'lv_font_fmt_txt_glyph_dsc_t': 8, 'lv_font_fmt_txt_cmap_t': 20,
+}
+
+# ------------------------------------------------------------------------
+# C source scanning
+# ------------------------------------------------------------------------
+
+def decode_c_string(body):
+    """C string literal body -> unicode text (UTF-8 source)"""
+    out = bytearray()
+    i = 0
+    simple = {'n': 10, 't': 9, 'r': 13, '0': 0, '\\': 92, '"': 34, "'": 39}
+    while i < len(body):
+        c = body[i]
+        if c != '\\':
+            out += c.encode('utf-8')
+            i += 1
+            continue
+        e = body[i + 1]
+        if e == 'x':
+            m = re.match(r'[0-9a-fA-F]+', body[i + 2:])
+            out.append(int(m.group(0), 16) & 0xFF)
+            i += 2 + len(m.group(0))
+        elif e in '01234567':
+            m = re.match(r'[0-7]{1,3}', body[i + 1:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += 1 + len(m.group(0))
+        else:
+            out.append(simple.get(e, ord(e)))
+            i += 2
+    return out.decode('utf-8', errors='replace')
+
+
+def tokenize(src):
+    """Split C source into code (comments and literals blanked) and string literals"""
+    code = []
+    strings = [] # (line, offset in code, text)
+    i, line, n = 0, 1, len(src)
+    length = 0 # of code
+    while i < n:
+        c = src[i]
+        if src.startswith('//', i):
+            j = src.find('\n', i)
+            i = n if j < 0 else j
+        elif src.startswith('/*', i):
+            j = src.find('*/', i + 2)
+            j = n if j < 0 else j + 2
+            line += src.count('\n', i, j)
+            code.append('\n' * src.count('\n', i, j))
+            length += len(code[-1])
+            i = j
+        elif c in '"\'':
+            j = i + 1
+            while j < n and src[j] != c:
+                j += 2 if src[j] == '\\' else 1
+            if c == '"':
+                strings.append((line, length, decode_c_string(src[i + 1:j])))
+                code.append('""')
+            else:
+                code.append("' '")
+            length += len(code[-1])
+            i = j + 1
+        else:
+            if c == '\n':
+                line += 1
+            code.append(c)
+            length += 1
+            i += 1
+    return ''.join(code), strings
+
+
+def read_defines():
+    """NAME -> integer value of the simple defines in lv_conf.h and the app headers"""
+    defines = {}
+    for path in [LV_CONF] + sorted(glob.glob(os.path.join(APP_DIR, '*.h'))):
+        with open(path, encoding='utf-8', errors='replace') as f:
+            for m in DEFINE_RE.finditer(f.read()):
+                defines.setdefault(m.group(1), int(m.group(2))) # first one: lv_conf.h overrides the defaults
+    return defines
+
+
+def eval_condition(expr, defines):
+    """value of a simple #if condition, None if unknown"""
+    expr = re.sub(r'//.*|/\*.*?\*/', '', expr).strip()
+    m = re.match(r'^(!?)\s*\(?\s*(\w+)\s*\)?$', expr)
+    if not m:
+        return None
+    name = m.group(2)
+    value = int(name) if name.isdigit() else defines.get(name)
+    if value is None:
+        return None
+    return (not value) if m.group(1) else bool(value)
+
+
+def strip_disabled(src, defines):
+    """blank the lines of blocks the preprocessor drops (unknown conditions are kept)"""
+    out = []
+    stack = [] # (active, branch taken: True/False/None if unknown)
+    for line in src.split('\n'):
+        d = re.match(r'\s*#\s*(if|ifdef|ifndef|elif|else|endif)\b(.*)', line)
+        outer = all(active for active, _ in stack)
+        if d:
+            kind, expr = d.group(1), d.group(2)
+            if kind == 'if':
+                value = eval_condition(expr, defines)
+                stack.append((value is not False, value))
+            elif kind in ('ifdef', 'ifndef'):
+                stack.append((True, None))
+            elif kind in ('elif', 'else') and stack:
+                taken = stack[-1][1]
+                if taken is None:
+                    stack[-1] = (True, None)
+                elif taken:
+                    stack[-1] = (False, True)
+                else:
+                    value = True if kind == 'else' else eval_condition(expr, defines)
+                    stack[-1] = (value is not False, value)
+            elif kind == 'endif' and stack:
+                stack.pop()
+            out.append(line)
+        else:
+            out.append(line if outer else '')
+    return '\n'.join(out)
+
+
+def bench_ranges(code):
+    """offsets of the bodies of benchmark functions in the code"""
+    out = []
+    for m in BENCH_FUNC_RE.finditer(code):
+        depth, i = 0, m.end() - 1
+        while i < len(code):
+            depth += {'{': 1, '}': -1}.get(code[i], 0)
+            if depth == 0:
+                break
+            i += 1
+        out.append((m.start(), i))
+    return out
+
+
+def app_sources():
+    files = []
+    defines = read_defines()
+    for ext in ('*.c', '*.cpp', '*.h'):
+        for path in glob.glob(os.path.join(APP_DIR, ext)):
+            name = os.path.basename(path)
+            if name in ('lv_conf.h', 'lv_drv_conf.h', 'lv_ex_conf.h'):
+                continue
+            if re.search(r'_bench\.\w+$', name):
+                continue # not part of the UI
+            with open(path, encoding='utf-8', errors='replace') as f:
+                src = f.read()
+            if 'lv_img_dsc_t' in src and 'LV_IMG_CF_' in src:
+                continue # image data
+            files.append((name, strip_disabled(src, defines)))
+    return files
+
+
+def read_symbols():
+    """LV_SYMBOL_xxx -> code point"""
+    symbols = {}
+    if not os.path.exists(SYMBOL_DEF):
+        print('warning: %s not found (lvgl submodule missing?), symbols ignored' % SYMBOL_DEF)
+        return symbols
+    with open(SYMBOL_DEF, encoding='utf-8') as f:
+        for m in re.finditer(r'#define\s+(LV_SYMBOL_\w+)\s+"([^"]*)"', f.read()):
+            text = decode_c_string(m.group(2))
+            if len(text) == 1:
+                symbols[m.group(1)] = ord(text)
+    return symbols
+
+
+def read_theme_fonts():
+    """theme font role -> built-in font name, from lv_conf.h"""
+    fonts = {}
+    with open(LV_CONF, encoding='utf-8', errors='replace') as f:
+        for m in re.finditer(r'#define\s+LV_THEME_DEFAULT_FONT_(\w+)\s+&lv_font_(\w+)', f.read()):
+            fonts[m.group(1).lower()] = m.group(2)
+    return fonts
+
+
+def enabled_fonts():
+    """built-in fonts enabled in lv_conf.h (outside of the watch profile)"""
+    with open(LV_CONF, encoding='utf-8', errors='replace') as f:
+        conf = f.read()
+    return [name for name, define in BUILTIN_FONTS.items()
+            if re.search(r'#define\s+%s\s+1\b' % define, conf)]
+
+
+class Usage:
+    def __init__(self):
+        self.fonts = {}        # font -> first location
+        self.codepoints = {}   # code point -> first location
+        self.dynamic = []      # locations with text unknown at build time
+
+    def add_font(self, name, loc):
+        self.fonts.setdefault(name, loc)
+
+    def add_text(self, text, loc):
+        for ch in text:
+            if ch != '\n':
+                self.codepoints.setdefault(ord(ch), loc)
+
+
+def scan(symbols, theme_fonts):
+    usage = Usage()
+    for role, font in theme_fonts.items():
+        usage.add_font(font, 'lv_conf.h (theme %s)' % role)
+
+    for name, src in app_sources():
+        code, strings = tokenize(src)
+        benches = bench_ranges(code)
+
+        def loc(ofs):
+            return '%s:%d' % (name, code.count('\n', 0, ofs) + 1)
+
+        def in_bench(ofs):
+            return any(lo <= ofs <= hi for lo, hi in benches)
+
+        for m in FONT_RE.finditer(code):
+            if not in_bench(m.start()):
+                usage.add_font(m.group(1), loc(m.start()))
+        for m in THEME_FONT_RE.finditer(code):
+            if m.group(1) in theme_fonts and not in_bench(m.start()):
+                usage.add_font(theme_fonts[m.group(1)], loc(m.start()))
+        for m in SYMBOL_RE.finditer(code):
+            if m.group(0) in symbols and not in_bench(m.start()):
+                usage.codepoints.setdefault(symbols[m.group(0)], loc(m.start()))
+
+        for line, ofs, text in strings:
+            if in_bench(ofs):
+                continue
+            # log output, include paths and the like are not drawn
+            stmt_start = max(code.rfind(';', 0, ofs), code.rfind('{', 0, ofs), code.rfind('}', 0, ofs))
+            line_start = code.rfind('\n', 0, ofs)
+            if LOG_RE.search(code, stmt_start + 1, ofs) or code[line_start + 1:ofs].lstrip().startswith('#'):
+                continue
+
+            where = '%s:%d' % (name, line)
+            specs = re.findall(r'%[-+ 0#]*\d*(?:\.\d+)?l?([a-zA-Z%])', text)
+            for spec in specs:
+                if spec in 'diuxX':
+                    for cp in DIGITS | (set(range(ord('a'), ord('g'))) if spec == 'x' else set()):
+                        usage.codepoints.setdefault(cp, where)
+            if 's' in specs or 'c' in specs:
+                usage.dynamic.append('%s  "%s"' % (where, text.replace('\n', '\\n')))
+            usage.add_text(re.sub(r'%[-+ 0#]*\d*(?:\.\d+)?l?[a-zA-Z%]', '', text), where)
+
+        for m in DYN_TEXT_RE.finditer(code):
+            if in_bench(m.start()):
+                continue
+            text_arg = m.group(2).split(',')[-1].strip()
+            if text_arg != '""' and not SYMBOL_RE.match(text_arg):
+                usage.dynamic.append('%s  %s(..., %s)' % (loc(m.start()), m.group(1), text_arg))
+    return usage
+
+# ------------------------------------------------------------------------
+# Font data size
+# ------------------------------------------------------------------------
+
+ARRAY_RE = re.compile(r'(?:static\s+)?(?:LV_ATTRIBUTE_LARGE_CONST\s+)?const\s+(\w+)\s+\w+\s*\[\s*\]\s*=\s*\{(.*?)\n\};', re.S)
+
+
+def font_data_size(path):
+    """bytes of the const font tables in a font C file, None if not found"""
+    if not path or not os.path.exists(path):
+        return None
+    with open(path, encoding='utf-8', errors='replace') as f:
+        code, _ = tokenize(f.read())
+    total = 0
+    for m in ARRAY_RE.finditer(code):
+        elem, body = m.group(1), m.group(2)
+        if elem.startswith('lv_'):
+            count = body.count('{')
+        else:
+            count = len([t for t in body.split(',') if t.strip()])
+        total += count * ELEM_SIZE.get(elem, 4)
+    return total
+
+
+def glyph_count(path):
+    if not path or not os.path.exists(path):
+        return None
+    with open(path, encoding='utf-8', errors='replace') as f:
+        return f.read().count('.bitmap_index')
+
+# ------------------------------------------------------------------------
+# Generation
+# ------------------------------------------------------------------------
+
+def ranges(codepoints):
+    """sorted code points -> lv_font_conv range list"""
+    out, cps = [], sorted(codepoints)
+    i = 0
+    while i < len(cps):
+        j = i
+        while j + 1 < len(cps) and cps[j + 1] == cps[j] + 1:
+            j += 1
+        out.append('0x%X' % cps[i] if i == j else '0x%X-0x%X' % (cps[i], cps[j]))
+        i = j + 1
+    return ','.join(out)
+
+
+def font_size(name):
+    return int(re.match(r'montserrat_(\d+)$', name).group(1))
+
+
+def generate(fonts, kept, text_cps, symbol_cps, args):
+    for name in fonts:
+        out = os.path.join(OUT_DIR, 'watch_%s.c' % name)
+        cmd = ['lv_font_conv', '--no-compress', '--no-prefilter', '--bpp', '4',
+               '--size', str(font_size(name)), '--format', 'lvgl',
+               '--lv-include', 'lvgl/lvgl.h', '--force-fast-kern-format',
+               '--font', args.ttf, '-r', ranges(text_cps)]
+        if symbol_cps:
+            cmd += ['--font', args.symbols, '-r', ranges(symbol_cps)]
+        cmd += ['-o', out]
+        print(' '.join(cmd))
+        subprocess.check_call(cmd, shell=(os.name == 'nt'))
+
+    with open(os.path.join(OUT_DIR, 'watch_fonts.inc'), 'w') as f:
+        f.write('/* Generated by font_subset.py, do not edit */\n\n')
+        for name in fonts:
+            f.write('#include "watch_%s.c"\n' % name)
+
+    with open(os.path.join(OUT_DIR, 'watch_fonts_conf.h'), 'w') as f:
+        f.write('/* Generated by font_subset.py, do not edit */\n\n')
+        f.write('/* built-in fonts off, except the ones used but not subsetted */\n')
+        for name, define in sorted(BUILTIN_FONTS.items(), key=lambda item: item[1]):
+            f.write('#define %-36s %d\n' % (define, 1 if name in kept else 0))
+        f.write('\n/* subsetted fonts under the built-in names */\n')
+        for name in fonts:
+            f.write('#define lv_font_%-28s watch_%s\n' % (name, name))
+        f.write('\n#define LV_FONT_CUSTOM_DECLARE')
+        for name in fonts:
+            f.write(' \\\n    LV_FONT_DECLARE(watch_%s)' % name)
+        f.write('\n')
+
+# ------------------------------------------------------------------------
+# Main
+# ------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description='Subset the fonts of the watch build profile')
+    parser.add_argument('--ttf', help='Montserrat TTF, generate the fonts (else dry run)')
+    parser.add_argument('--symbols', help='FontAwesome font of the LV_SYMBOL_* glyphs')
+    parser.add_argument('--no-ascii', action='store_true', help='keep only the used characters')
+    args = parser.parse_args()
+
+    symbols = read_symbols()
+    symbol_set = set(symbols.values())
+    usage = scan(symbols, read_theme_fonts())
+
+    used = sorted(usage.fonts)
+    subset = [f for f in used if re.match(r'montserrat_\d+$', f)]
+    other = [f for f in used if f not in subset and f in enabled_fonts()] # e.g. CJK, if enabled
+
+    # characters of the other fonts (e.g. CJK, built-in or loaded from a file)
+    # are not added to the subsets
+    kept = KEPT_CPS
+
+    cps = set(usage.codepoints) - kept
+    if not args.no_ascii:
+        cps |= ASCII
+    symbol_cps = cps & symbol_set
+    text_cps = cps - symbol_set
+
+    # glyphs the source fonts do not have
+    available = set()
+    if args.ttf:
+        try:
+            from fontTools.ttLib import TTFont
+            for path in (args.ttf, args.symbols):
+                if path:
+                    available |= set(TTFont(path).getBestCmap())
+        except ImportError:
+            print('warning: fontTools not installed, checking against the built-in ranges')
+    if not available:
+        for lo, hi in BUILTIN_RANGES:
+            available |= set(range(lo, hi + 1))
+        available |= symbol_set
+    missing = sorted(cp for cp in usage.codepoints if cp not in available and cp not in kept)
+
+    if args.ttf:
+        if symbol_cps and not args.symbols:
+            parser.error('--symbols is required for the LV_SYMBOL_* glyphs')
+        generate(subset, other, text_cps, symbol_cps, args)
+
+    # report
+    print('\nFonts used:')
+    for name in used:
+        print('  %-26s %s' % (name, usage.fonts[name]))
+    if other:
+        print('  (not subsetted, kept as built-in: %s)' % ', '.join(other))
+    print('\nCharacters: %d text, %d symbols%s' % (len(text_cps), len(symbol_cps),
+          '' if args.no_ascii else ' (incl. printable ASCII)'))
+
+    print('\nFlash (font tables):')
+    saved, unknown = 0, False
+    print('  %-26s %10s %10s %10s' % ('font', 'built-in', 'subset', 'saved'))
+    for name in enabled_fonts():
+        builtin_path = os.path.join(LVGL_FONT_DIR, 'lv_font_%s.c' % name)
+        before = font_data_size(builtin_path)
+        if name in subset:
+            after = font_data_size(os.path.join(OUT_DIR, 'watch_%s.c' % name))
+            if after is None and before is not None:
+                # dry run: scale by the number of glyphs
+                glyphs = glyph_count(builtin_path)
+                after = before * len(cps) // glyphs if glyphs else None
+                mark = '~'
+            else:
+                mark = ''
+        elif name in other:
+            after, mark = before, ''
+        else:
+            after, mark = 0, ''
+        if before is None or after is None:
+            unknown = True
+            print('  %-26s %10s %10s %10s' % (name, '?', '?', '?'))
+            continue
+        saved += before - after
+        print('  %-26s %10d %9s%s %10d' % (name, before, mark, after, before - after))
+    print('  total saved: %d bytes%s' % (saved, ' (incomplete, lvgl sources missing)' if unknown else ''))
+
+    print('\nGlyphs missing in the source fonts (drawn as nothing):')
+    for cp in missing:
+        print('  U+%04X %r  %s' % (cp, chr(cp), usage.codepoints[cp]))
+    if not missing:
+        print('  none')
+
+    print('\nText only known at runtime (could need glyphs not in the subset):')
+    for site in usage.dynamic:
+        print('  ' + site)
+    if not usage.dynamic:
+        print('  none')
+
+    return 1 if missing else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
+
+# ------------------------------------------------------------------------
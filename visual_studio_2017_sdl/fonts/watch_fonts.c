@@ -0,0 +1,15 @@
+/**
+ * @file watch_fonts.c
+ * Subsetted fonts of the watch build profile (`LV_WATCH_PROFILE` in lv_conf.h).
+ * After changing UI texts, regenerate `watch_fonts.inc` and `watch_fonts_conf.h`:
+ *   python3 fonts/font_subset.py --ttf <Montserrat TTF> --symbols <FontAwesome font>
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl/lvgl.h"
+
+#if LV_WATCH_PROFILE
+#include "watch_fonts.inc"
+#endif
@@ -5,11 +5,30 @@
 
 #include "lvgl/lvgl.h"
 #include "gui.h"
+#include "overdraw.h"
+#include "area_merge.h"
+#include "ui_txn.h"
+#include "font_cache.h"
+#include "label_fast.h"
+#include "label_text.h"
+#include "style_pool.h"
+#include "vlist.h"
+#include "wifi_model.h"
+#include "layer_cache.h"
+#include "app_arena.h"
+#include "tlsf_mem.h"
+#include "mem_telemetry.h"
+#include "mem_profile.h"
 
 // display size
 #define WIDTH  240
 #define HEIGHT 240
 
+// hidden apps are deleted (least recently shown first) while the heap uses more
+#ifndef APP_HEAP_BUDGET
+#define APP_HEAP_BUDGET (40U * 1024U)
+#endif
+
 extern "C" LV_IMG_DECLARE(step);
 extern "C" LV_IMG_DECLARE(white_face);
 extern "C" LV_IMG_DECLARE(mickey);
@@ -72,11 +91,13 @@ public:
 
     void create(lv_obj_t *parent)
     {
+        MEM_PROFILE_SCOPE(getName(), __FUNCTION__);
         if (! parent)
-            parent = lv_obj_create(NULL, NULL); // new screen
+            parent = app_arena_create_screen(APP_ARENA_SIZE); // new screen, objects in its arena
+        app_arena_begin(parent);
 
         lv_obj_t *tile = lv_cont_create(parent, NULL);
-        lv_obj_set_style_local_border_side(tile, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+        style_pool_add_int(tile, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
         lv_obj_set_size(tile, WIDTH, HEIGHT);
 
         populate(tile);
@@ -84,16 +105,49 @@ public:
         lv_obj_set_user_data(tile, this);
         lv_obj_set_event_cb(tile, tile_cb);
 
+        app_arena_end();
         screen = parent;
     }
 
+    // delete the widgets, the app is created again when shown
+    void destroy()
+    {
+        if (!screen)
+            return;
+
+        lv_obj_del(screen);
+        screen = NULL;
+        forget();
+    }
+
+    bool created() const
+    {
+        return screen != NULL;
+    }
+
+    bool visible() const
+    {
+        return screen && (screen == lv_scr_act());
+    }
+
+    uint32_t shown_elaps() const
+    {
+        return lv_tick_elaps(last_shown);
+    }
+
+    // owner of the memory in the heap profile
+    virtual const char *getName() const
+    {
+        return "App";
+    }
+
     virtual void populate(lv_obj_t *parent)
     {
         lv_cont_set_layout(parent, LV_LAYOUT_CENTER);
 
         // label
         lv_obj_t *label = lv_label_create(parent, NULL);
-        lv_obj_set_style_local_text_font(label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, &lv_font_montserrat_24);
+        style_pool_add_ptr(label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_TEXT_FONT, font_cache_wrap(&lv_font_montserrat_24));
         lv_label_set_static_text(label, "Hallo Tina\n\nAlles Gute zum\n10. Geburtstag!!!");
         lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
     }
@@ -142,7 +196,13 @@ public:
     virtual void show()
     {
         if (screen)
+        {
             lv_scr_load(screen);
+#if STYLE_POOL_REPORT
+            style_pool_report(screen);
+#endif
+        }
+        last_shown = lv_tick_get();
     }
 
     virtual void anim()
@@ -151,15 +211,16 @@ public:
     }
 
 protected:
+    // widgets deleted: clear the pointers to them
+    virtual void forget() {}
+
     lv_obj_t *screen;
+    uint32_t last_shown;
 };
 
 // ------------------------------------------------------------------------
 // forward declaration of local functions
 
-//static bool showApp();
-//static void createApp(uint16_t id);
-
 static void startAnim(App *app);
 
 // ------------------------------------------------------------------------
@@ -169,15 +230,21 @@ static void startAnim(App *app);
 class CalendarApp : public App
 {
 public:
+    virtual const char *getName() const
+    {
+        return "Kalender";
+    }
+
     virtual void populate(lv_obj_t *parent)
     {
         cal = lv_calendar_create(parent, NULL);
-        lv_obj_set_style_local_border_side(cal, LV_CALENDAR_PART_BG, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
-        lv_obj_set_style_local_text_color(cal, LV_CALENDAR_PART_DATE, LV_STATE_DISABLED, LV_COLOR_MAKE(0x40, 0x40, 0x40));
+        style_pool_add_int(cal, LV_CALENDAR_PART_BG, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
+        style_pool_add_color(cal, LV_CALENDAR_PART_DATE, LV_STATE_DISABLED, LV_STYLE_TEXT_COLOR, LV_COLOR_MAKE(0x40, 0x40, 0x40));
         lv_calendar_set_day_names(cal, day_names);
         lv_calendar_set_month_names(cal, month_names);
         lv_obj_set_size(cal, WIDTH, HEIGHT);
         lv_page_glue_obj(cal, true);
+        layer_cache_enable(cal); // changes once a day
 
         lv_obj_set_user_data(cal, this);
         lv_obj_set_event_cb(cal, cal_cb);
@@ -185,8 +252,9 @@ public:
         // Make the date number smaller to be sure they fit into their area
         //lv_obj_set_style_local_text_font(cal, LV_CALENDAR_PART_DATE, LV_STATE_DEFAULT, lv_theme_get_font_small());
 
-        // Set date
-        //update(2020, 9, 22);
+        // Set date, if known already
+        if (today.year)
+            lv_calendar_set_today_date(cal, &today);
     }
 
     static void cal_cb(lv_obj_t * obj, lv_event_t event)
@@ -226,11 +294,12 @@ public:
 
     void update(uint16_t year, uint16_t month, uint16_t day)
     {
-        // set today's date
-        lv_calendar_date_t today;
+        // set today's date, kept while the calendar is deleted
         today.year = year;
         today.month = (int8_t)month;
         today.day = (int8_t)day;
+        if (!cal)
+            return;
         lv_calendar_set_today_date(cal, &today);
 
         // show
@@ -240,14 +309,22 @@ public:
     virtual void show()
     {
         // show today's date
-        lv_calendar_date_t *today = lv_calendar_get_today_date(cal);
-        lv_calendar_set_showed_date(cal, today);
+        if (cal && today.year)
+            lv_calendar_set_showed_date(cal, &today);
 
         // show app
         App::show();
     }
 
+protected:
+    virtual void forget()
+    {
+        cal = NULL;
+    }
+
 private:
+    lv_calendar_date_t today;
+
     // GUI
     lv_obj_t *cal;
 };
@@ -259,6 +336,11 @@ private:
 class LevelApp : public App
 {
 public:
+    virtual const char *getName() const
+    {
+        return "Wasserwaage";
+    }
+
     virtual void populate(lv_obj_t *parent)
     {
         lv_cont_set_layout(parent, LV_LAYOUT_OFF);
@@ -273,9 +355,16 @@ public:
         static lv_point_t vert[2] = { {0, -HEIGHT / 2}, {0, HEIGHT / 2} };
 
         static lv_style_t style_line;
-        lv_style_init(&style_line);
-        lv_style_set_line_width(&style_line, LV_STATE_DEFAULT, 1);
-        lv_style_set_line_color(&style_line, LV_STATE_DEFAULT, LV_COLOR_GRAY);
+        static bool style_line_init = false;
+        if (!style_line_init) // once, the app is created again after eviction
+        {
+            style_line_init = true;
+            app_arena_begin(NULL); // static, not in the app's arena
+            lv_style_init(&style_line);
+            lv_style_set_line_width(&style_line, LV_STATE_DEFAULT, 1);
+            lv_style_set_line_color(&style_line, LV_STATE_DEFAULT, LV_COLOR_GRAY);
+            app_arena_end();
+        }
 
         lv_obj_t * line = lv_line_create(parent, NULL);
         lv_obj_add_style(line, LV_LINE_PART_MAIN, &style_line);
@@ -335,6 +424,12 @@ public:
         startAnim(this);
     }
 
+protected:
+    virtual void forget()
+    {
+        bubble = NULL;
+    }
+
 private:
     // GUI
     lv_obj_t *bubble;
@@ -347,6 +442,11 @@ private:
 class BatApp : public App
 {
 public:
+    virtual const char *getName() const
+    {
+        return "Batterie";
+    }
+
     virtual void populate(lv_obj_t *parent)
     {
         lv_obj_t *label;
@@ -372,6 +472,24 @@ public:
         //lv_obj_set_auto_realign(label, true);
         //lv_obj_align(label, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -20);
         lab_mem = label;
+
+        // label
+        label = lv_label_create(parent, NULL);
+        lv_label_set_static_text(label, "");
+        lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
+        lab_heap = label;
+
+        // heap history: used and fragmentation
+        lv_obj_t *chart = lv_chart_create(parent, NULL);
+        lv_obj_set_size(chart, WIDTH * 2 / 3, HEIGHT / 4);
+        lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+        lv_chart_set_range(chart, 0, 100);
+        lv_chart_set_div_line_count(chart, 1, 0);
+        lv_chart_set_point_count(chart, MEM_TELEMETRY_HISTORY);
+        lv_obj_set_style_local_size(chart, LV_CHART_PART_SERIES, LV_STATE_DEFAULT, 0); // no dots
+        ser_used = lv_chart_add_series(chart, lv_theme_get_color_primary());
+        ser_frag = lv_chart_add_series(chart, lv_theme_get_color_secondary());
+        chart_mem = chart;
     }
 
     virtual void show()
@@ -380,21 +498,119 @@ public:
         if (lab_level)
         {
             uint16_t level = get_bat_level();
-            lv_label_set_text_fmt(lab_level, "Batterie:\n%d %%", level);
+            label_fast_set_text_fmt(lab_level, "Batterie:\n%d %%", level);
         }
         if (lab_mem)
         {
             uint32_t mem = get_free_mem();
-            lv_label_set_text_fmt(lab_mem, "Freier Speicher:\n%d bytes", mem);
+            label_fast_set_text_fmt(lab_mem, "Freier Speicher:\n%d bytes", mem);
+        }
+        if (lab_heap)
+        {
+            mem_sample_t s;
+            mem_telemetry_get(0, &s);
+            label_fast_set_text_fmt(lab_heap, "Block %d, Fragm. %d %%\nmax. belegt %d bytes",
+                s.free_biggest, s.frag_pct, mem_telemetry_get_high_water());
+        }
+        if (chart_mem)
+        {
+            // oldest first, unknown ones before
+            for (int16_t age = MEM_TELEMETRY_HISTORY - 1; age >= 0; age--)
+            {
+                mem_sample_t s;
+                bool known = mem_telemetry_get(age, &s);
+                lv_chart_set_next(chart_mem, ser_used, known ? s.used_pct : LV_CHART_POINT_DEF);
+                lv_chart_set_next(chart_mem, ser_frag, known ? s.frag_pct : LV_CHART_POINT_DEF);
+            }
         }
 
         // show app
         App::show();
     }
 
+protected:
+    virtual void forget()
+    {
+        lab_level = lab_mem = lab_heap = chart_mem = NULL;
+    }
+
 private:
     // GUI
-    lv_obj_t *lab_level, *lab_mem;
+    lv_obj_t *lab_level, *lab_mem, *lab_heap;
+    lv_obj_t *chart_mem;
+    lv_chart_series_t *ser_used, *ser_frag;
+};
+
+// ------------------------------------------------------------------------
+// WiFi App
+// ------------------------------------------------------------------------
+
+class WiFiApp : public App
+{
+public:
+    virtual const char *getName() const
+    {
+        return "WLAN";
+    }
+
+    virtual void populate(lv_obj_t *parent)
+    {
+        lv_cont_set_layout(parent, LV_LAYOUT_OFF);
+
+        // label
+        lv_obj_t *label = lv_label_create(parent, NULL);
+        lv_label_set_static_text(label, "WLAN");
+        lv_obj_align(label, NULL, LV_ALIGN_IN_TOP_MID, 0, 10);
+
+        // scan results, just the visible rows are objects
+        list = vlist_create(parent, row_cb);
+        lv_obj_set_size(list, WIDTH - 40, HEIGHT - 60);
+        lv_obj_align(list, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -10);
+        lv_obj_set_event_cb(list, list_cb);
+        vlist_set_count(list, wifi_model_get_count());
+    }
+
+    static void row_cb(lv_obj_t *list, uint16_t index, vlist_row_t *row)
+    {
+        row->symbol = LV_SYMBOL_WIFI;
+        strncpy(row->text, wifi_model_get_ssid(index), VLIST_TEXT_LEN);
+    }
+
+    static void list_cb(lv_obj_t *obj, lv_event_t event)
+    {
+        if (event == LV_EVENT_VALUE_CHANGED)
+        {
+            uint32_t index = *(uint32_t *)lv_event_get_data();
+            MY_LOG("WiFi %s selected", wifi_model_get_ssid((uint16_t)index));
+            showHome();
+        }
+    }
+
+    void update()
+    {
+        if (list)
+            vlist_set_count(list, wifi_model_get_count());
+    }
+
+    virtual void show()
+    {
+        if (list)
+            MY_LOG("WiFi list: %d networks (%d bytes), %d row objects",
+                wifi_model_get_count(), wifi_model_get_mem_size(), vlist_get_row_objs(list));
+
+        // show app
+        App::show();
+    }
+
+protected:
+    virtual void forget()
+    {
+        list = NULL;
+    }
+
+private:
+    // GUI
+    lv_obj_t *list;
 };
 
 // ------------------------------------------------------------------------
@@ -404,9 +620,18 @@ private:
 class WatchApp : public App
 {
 public:
+    virtual const char *getName() const
+    {
+        return "Uhr";
+    }
+
     virtual void populate(lv_obj_t *parent)
     {
         lv_cont_set_layout(parent, LV_LAYOUT_OFF);
+        tile = parent;
+
+        // inherited by the labels (symbols, date, steps)
+        style_pool_add_ptr(parent, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_TEXT_FONT, font_cache_wrap(lv_theme_get_font_normal()));
 
         img_bg = lv_img_create(parent, NULL);
         lv_img_set_src(img_bg, &white_face);
@@ -422,11 +647,13 @@ public:
         lv_label_set_align(lab_tr, LV_LABEL_ALIGN_RIGHT);
         lv_obj_set_auto_realign(lab_tr, true);
         lv_obj_align(lab_tr, NULL, LV_ALIGN_IN_TOP_RIGHT, -2, 2);
+        txt_tr.attach(lab_tr);
 
         lab_bl = lv_label_create(parent, NULL);
         lv_label_set_static_text(lab_bl, "Di\n22.9.");
         lv_obj_set_auto_realign(lab_bl, true);
         lv_obj_align(lab_bl, NULL, LV_ALIGN_IN_BOTTOM_LEFT, 2, -2);
+        txt_bl.attach(lab_bl);
 
         lv_obj_t *icon = lv_img_create(parent, NULL);
         lv_img_set_src(icon, &step);
@@ -437,6 +664,7 @@ public:
         lv_label_set_align(lab_br, LV_LABEL_ALIGN_RIGHT);
         lv_obj_set_auto_realign(lab_br, true);
         lv_obj_align(lab_br, NULL, LV_ALIGN_IN_BOTTOM_RIGHT, -2, -2);
+        txt_br.attach(lab_br);
 
         img_fig = lv_img_create(parent, NULL);
         lv_img_set_src(img_fig, &mickey);
@@ -453,6 +681,8 @@ public:
         img_sec = lv_img_create(parent, NULL);
         lv_img_set_src(img_sec, &hand_sec);
         lv_obj_align(img_sec, NULL, LV_ALIGN_CENTER, 0, 0);
+
+        overdraw_attach(parent);
     }
 
     virtual void tile_clicked_cb()
@@ -471,9 +701,6 @@ public:
             return;
         }
 
-//      if (!showApp())
-//          createApp(corner);
-
         showApp(corner);
     }
 
@@ -485,10 +712,14 @@ public:
 
     void updateTime(uint16_t hour, uint16_t min, uint16_t sec)
     {
+        MEM_PROFILE_SCOPE(getName(), __FUNCTION__);
+        area_merge_scenario("watch app");
+        ui_txn_begin(tile);
         lv_img_set_angle(img_fig, (sec & 1) ? -25 : 25);
         lv_img_set_angle(img_hour, (hour % 12) * 300 + min * 5);
         lv_img_set_angle(img_min, min * 60 + sec);
         lv_img_set_angle(img_sec, sec * 60);
+        ui_txn_commit();
     }
 
     void updateWiFi(bool connected)
@@ -508,15 +739,19 @@ public:
             txt_level = LV_SYMBOL_BATTERY_2;
         else if (level >= 10)
             txt_level = LV_SYMBOL_BATTERY_1;
-        lv_label_set_text_fmt(lab_tr, "%s %s ", txt_charge, txt_level);
+        MEM_PROFILE_SCOPE(getName(), __FUNCTION__);
+        ui_txn_begin(tile);
+        txt_tr.setTextFmt("%s %s ", txt_charge, txt_level);
+        ui_txn_commit();
     }
 
     void updateDate(uint16_t year, uint16_t month, uint16_t day, uint16_t weekday)
     {
+        MEM_PROFILE_SCOPE(getName(), __FUNCTION__);
         const char *name = "";
         if (weekday < 7)
             name = day_names[weekday];
-        lv_label_set_text_fmt(lab_bl, "%s\n%d.%d.", name, day, month);
+        txt_bl.setTextFmt("%s\n%d.%d.", name, day, month);
 
         if (cal)
             cal->update(year, month, day);
@@ -524,7 +759,8 @@ public:
 
     void updateSteps(uint32_t count)
     {
-        lv_label_set_text_fmt(lab_br, "%d", count);
+        MEM_PROFILE_SCOPE(getName(), __FUNCTION__);
+        txt_br.setTextFmt("%d", count);
     }
 
     void startAnim(App *app)
@@ -555,8 +791,12 @@ protected:
     CalendarApp *cal;
 
     // GUI
+    lv_obj_t *tile;
     lv_obj_t *img_bg, *img_fig, *img_hour, *img_min, *img_sec;
     lv_obj_t *lab_tl, *lab_tr, *lab_bl, *lab_br;
+    LabelText<16> txt_tr; // battery symbols
+    LabelText<24> txt_bl; // weekday and date
+    LabelText<12> txt_br; // steps
 };
 
 // ------------------------------------------------------------------------
@@ -567,11 +807,16 @@ static WatchApp home;
 static BatApp bat;
 static CalendarApp cal;
 static LevelApp level;
+static WiFiApp wifi;
 static App dummy;
 
 void wifi_list_add(const char *ssid)
 {
+    if (!wifi_model_add(ssid))
+        return; // listed already
+
     MY_LOG("ssid: %s", ssid);
+    wifi.update();
 }
 
 void wifi_connect_status(bool result)
@@ -599,6 +844,7 @@ void updateBatteryCalc()
 
 void updateBatteryLevel()
 {
+    HeapCheck check("updateBatteryLevel");
     uint16_t level = get_bat_level();
     uint16_t charging = get_bat_charging();
     MY_LOG("bat level %d%% %s", level, (charging ? "charging" : ""));
@@ -608,17 +854,20 @@ void updateBatteryLevel()
 void updateStepCounter(uint32_t count)
 {
     MY_LOG("step count %d", count);
+    HeapCheck check("updateStepCounter");
     home.updateSteps(count);
 }
 
 void updateDate(uint16_t year, uint16_t month, uint16_t day, uint16_t weekday)
 {
     MY_LOG("Date %04d-%02d-%02d (%d)", year, month, day, weekday);
+    HeapCheck check("updateDate");
     home.updateDate(year, month, day, weekday);
 }
 
 void updateTime(uint16_t hour, uint16_t min, uint16_t sec)
 {
+    HeapCheck check("updateTime");
     home.updateTime(hour, min, sec);
 }
 
@@ -655,77 +904,102 @@ static void startAnim(App *app)
 // GUI launcher
 // ------------------------------------------------------------------------
 
-//  static bool showApp()
-//  {
-//      if (!app)
-//          return false;
-//  
-//      MY_LOG("Back to app");
-//      app->show();
-//  }
-//  
-//  static void createApp(uint16_t id)
-//  {
-//      MY_LOG("New app");
-//      lv_obj_t *screen = lv_obj_create(NULL, NULL);
-//  
-//      if (id == 3)
-//          app = new CalendarApp();
-//      else
-//          app = new App();
-//  
-//      if (app)
-//      {
-//          app->create(screen);
-//          app->show();
-//      }
-//      else
-//          lv_obj_del(screen);
-//  }
-//
-//  static void killApp(void *data)
-//  {
-//      MY_LOG("Kill app");
-//      delete app;
-//      app = NULL;
-//  }
+static App *apps[] = { &wifi, &bat, &cal, &level, &dummy };
+static bool evict_pending;
+static uint16_t shown_corner; // 0: home
+
+static App *getApp(uint16_t corner)
+{
+    switch (corner)
+    {
+    case 1:  return &wifi;
+    case 2:  return &bat;
+    case 3:  return &cal;
+    case 4:  return &level;
+    default: return &dummy;
+    }
+}
+
+// delete hidden apps, least recently shown first, while the heap is above the budget
+static void evictApps()
+{
+    for (;;)
+    {
+        lv_mem_monitor_t mon;
+        mem_monitor(&mon);
+        uint32_t used = mon.total_size - mon.free_size;
+        if (used <= APP_HEAP_BUDGET)
+            return;
+
+        App *lru = NULL;
+        for (uint16_t i = 0; i < sizeof(apps) / sizeof(apps[0]); i++)
+        {
+            App *app = apps[i];
+            if (app->created() && !app->visible() && (!lru || (app->shown_elaps() > lru->shown_elaps())))
+                lru = app;
+        }
+        if (!lru)
+            return;
+
+        MY_LOG("Heap %d bytes used, app not shown for %d s deleted", used, lru->shown_elaps() / 1000);
+        lru->destroy();
+    }
+}
+
+// the hidden app may be the one calling
+static void evictTask(void *data)
+{
+    evict_pending = false;
+    evictApps();
+}
 
 void showApp(uint16_t corner)
 {
     MY_LOG("Show app %d", corner);
 
-    switch (corner)
+    App *app = getApp(corner);
+    if (!app->created())
     {
-    case 2:  bat.show(); break;
-    case 3:  cal.show(); break;
-    case 4:  level.show(); break;
-    default: dummy.show(); break;
+        evictApps(); // room for the new app
+        app->create(NULL);
     }
+    app->show();
+    shown_corner = corner;
 }
 
 void showHome()
 {
     MY_LOG("Back to home");
     home.show();
+    shown_corner = 0;
+
+    if (!evict_pending)
+    {
+        evict_pending = true;
+        lv_async_call(evictTask, NULL);
+    }
+}
 
-//  if (app)
-//      lv_async_call(killApp, NULL);
+uint16_t getShownApp()
+{
+    return shown_corner;
 }
 
 void setupGui()
 {
+    uint32_t start = get_time_us();
     lv_task_t *anim = lv_task_create(animTask, 100, LV_TASK_PRIO_OFF, NULL);
 
+    // apps are created when shown first
     home.create(lv_scr_act());
-    bat.create(NULL);
-    cal.create(NULL);
-    level.create(NULL);
-    dummy.create(NULL);
-
     home.setup(anim, &cal);
 
     lv_task_create(updateTask,   1000, LV_TASK_PRIO_MID, NULL);
     lv_task_create(batteryTask, 30000, LV_TASK_PRIO_LOW, NULL);
+
+    lv_mem_monitor_t mon;
+    mem_monitor(&mon);
+    MY_LOG("GUI setup: %d us, heap %d bytes used", get_time_us() - start, mon.total_size - mon.free_size);
 }
 
 // ------------------------------------------------------------------------
@@ -31,6 +31,8 @@ uint16_t get_bat_charging(void);
 
 uint32_t get_free_mem(void);
 
+uint32_t get_time_us(void); // for measurements
+
 void get_accel(lv_point_t *dir);
 
 void wifi_list_add(const char *ssid);
@@ -55,6 +57,7 @@ void updateDate(uint16_t year, uint16_t month, uint16_t day, uint16_t weekday);
 void setupGui(void);
 void showHome(void);
 void showApp(uint16_t corner);
+uint16_t getShownApp(void); // corner of showApp(), 0: home
 
 #ifdef __cplusplus
 } // extern "C"
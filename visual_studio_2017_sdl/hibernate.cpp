@@ -0,0 +1,261 @@
+// ------------------------------------------------------------------------
+// Hibernate: snapshot of the UI state and the last frame, instant resume
+// ------------------------------------------------------------------------
+//
+// A cold start creates all widgets of the home screen before the first
+// pixel is shown. Here the model of the UI (clock, alarm, timers, settings,
+// active tile or app) and the last presented frame are saved when the
+// window is closed. On the next start the frame is decoded and presented
+// before any widget exists; the widget tree is rebuilt from the model by an
+// async call, which runs before the first refresh of LVGL. The frame is run
+// length coded (PackBits on pixels): watch faces are mostly flat areas.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "my_watch.h"
+#include "sdl_monitor.h"
+#include "hibernate.h"
+
+#if USE_HIBERNATE
+
+#define MAGIC   "HIB1"
+#define VERSION 1
+
+#define FRAME_PX   (LV_HOR_RES_MAX * LV_VER_RES_MAX)
+#define FRAME_MAX  (FRAME_PX * sizeof(lv_color_t) + FRAME_PX / 128 + 1) // coded, worst case
+
+typedef struct
+{
+    char magic[4];
+    uint8_t version;
+    uint8_t ui;          // HIBERNATE_UI_...
+    uint8_t color_depth; // the frame is stored as lv_color_t
+    uint8_t reserved;
+    uint16_t hor_res, ver_res;
+    uint16_t app;        // HIBERNATE_UI_GUI: getShownApp()
+    my_watch_state_t watch;
+    uint32_t frame_size; // bytes following
+} header_t;
+
+static uint8_t blob[sizeof(header_t) + FRAME_MAX];
+static lv_color_t frame[FRAME_PX];
+
+static bool initialized;
+static uint8_t running_ui;
+
+// resume
+static header_t resumed;
+static hibernate_setup_cb_t rebuild_setup_cb;
+
+// ------------------------------------------------------------------------
+// Frame coding
+// ------------------------------------------------------------------------
+
+// control byte 0..127: 1..128 pixels follow, 128..255: next pixel repeated 2..129 times
+static uint32_t encode(const lv_color_t *px, uint32_t n, uint8_t *out)
+{
+    uint8_t *o = out;
+    uint32_t i = 0;
+    while (i < n)
+    {
+        uint32_t run = 1;
+        while ((i + run < n) && (run < 129) && (px[i + run].full == px[i].full))
+            run++;
+
+        if (run >= 2)
+        {
+            *o++ = (uint8_t)(run + 126);
+            memcpy(o, &px[i], sizeof(lv_color_t));
+            o += sizeof(lv_color_t);
+            i += run;
+        }
+        else
+        {
+            // up to the next run
+            uint32_t lit = 1;
+            while ((i + lit < n) && (lit < 128) &&
+                   !((i + lit + 1 < n) && (px[i + lit].full == px[i + lit + 1].full)))
+                lit++;
+
+            *o++ = (uint8_t)(lit - 1);
+            memcpy(o, &px[i], lit * sizeof(lv_color_t));
+            o += lit * sizeof(lv_color_t);
+            i += lit;
+        }
+    }
+    return (uint32_t)(o - out);
+}
+
+static bool decode(const uint8_t *in, uint32_t size, lv_color_t *px, uint32_t n)
+{
+    const uint8_t *end = in + size;
+    uint32_t i = 0;
+    while (in < end)
+    {
+        uint8_t c = *in++;
+        uint32_t cnt   = (c < 128) ? c + 1 : c - 126;
+        uint32_t bytes = (c < 128) ? cnt * sizeof(lv_color_t) : sizeof(lv_color_t);
+        if ((i + cnt > n) || (bytes > (uint32_t)(end - in)))
+            return false;
+
+        if (c < 128)
+            memcpy(&px[i], in, bytes);
+        else
+        {
+            lv_color_t col;
+            memcpy(&col, in, sizeof(col));
+            for (uint32_t k = 0; k < cnt; k++)
+                px[i + k] = col;
+        }
+        in += bytes;
+        i  += cnt;
+    }
+    return i == n;
+}
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static void quit_cb(void)
+{
+    hibernate_save();
+}
+
+// read and check the snapshot, present its frame
+static bool load(header_t *hdr)
+{
+    FILE *fp = fopen(HIBERNATE_FILE, "rb");
+    if (!fp)
+        return false;
+    uint32_t size = (uint32_t)fread(blob, 1, sizeof(blob), fp);
+    fclose(fp);
+
+    memcpy(hdr, blob, LV_MATH_MIN(size, sizeof(header_t)));
+    if ((size < sizeof(header_t)) || memcmp(hdr->magic, MAGIC, 4) || (hdr->version != VERSION) ||
+        (hdr->color_depth != LV_COLOR_DEPTH) || (hdr->hor_res != LV_HOR_RES_MAX) || (hdr->ver_res != LV_VER_RES_MAX) ||
+        (hdr->frame_size != size - sizeof(header_t)))
+    {
+        MY_LOG("Hibernate: %s does not match, cold start", HIBERNATE_FILE);
+        return false;
+    }
+
+    if (!decode(blob + sizeof(header_t), hdr->frame_size, frame, FRAME_PX))
+    {
+        MY_LOG("Hibernate: frame of %s corrupt, cold start", HIBERNATE_FILE);
+        return false;
+    }
+
+    sdl_monitor_show_frame(frame);
+    return true;
+}
+
+static void rebuild_cb(void *data)
+{
+    uint32_t start = get_time_us();
+
+    rebuild_setup_cb(resumed.ui);
+    if (resumed.ui == HIBERNATE_UI_WATCH)
+        my_watch_set_state(&resumed.watch);
+    else if (resumed.app)
+        showApp(resumed.app);
+
+    MY_LOG("Hibernate: UI rebuilt in %d us", get_time_us() - start);
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+void hibernate_init(uint8_t ui)
+{
+    running_ui  = ui;
+    initialized = true;
+    sdl_monitor_set_quit_cb(quit_cb);
+}
+
+bool hibernate_save(void)
+{
+    if (!initialized)
+        return false;
+
+    uint32_t start = get_time_us();
+    header_t *hdr = (header_t *)blob;
+    memset(hdr, 0, sizeof(header_t));
+    memcpy(hdr->magic, MAGIC, 4);
+    hdr->version     = VERSION;
+    hdr->ui          = running_ui;
+    hdr->color_depth = LV_COLOR_DEPTH;
+    hdr->hor_res     = LV_HOR_RES_MAX;
+    hdr->ver_res     = LV_VER_RES_MAX;
+    if (running_ui == HIBERNATE_UI_WATCH)
+        my_watch_get_state(&hdr->watch);
+    else
+        hdr->app = getShownApp();
+    hdr->frame_size = encode(sdl_monitor_get_frame(), FRAME_PX, blob + sizeof(header_t));
+
+    uint32_t size = sizeof(header_t) + hdr->frame_size;
+    FILE *fp = fopen(HIBERNATE_FILE, "wb");
+    if (!fp)
+    {
+        MY_LOG("Hibernate: cannot write %s", HIBERNATE_FILE);
+        return false;
+    }
+    bool ok = (fwrite(blob, 1, size, fp) == size);
+    fclose(fp);
+
+    MY_LOG("Hibernate: %d bytes written in %d us, frame coded to %d%%", size, get_time_us() - start,
+        (uint32_t)(hdr->frame_size * 100 / (FRAME_PX * sizeof(lv_color_t))));
+    return ok;
+}
+
+bool hibernate_resume(hibernate_setup_cb_t setup_cb)
+{
+    uint32_t start = get_time_us();
+    bool ok = load(&resumed);
+    remove(HIBERNATE_FILE); // once: a UI crashing on restore gets a cold start next time
+    if (!ok)
+        return false;
+
+    MY_LOG("Hibernate: saved frame presented in %d us", get_time_us() - start);
+    rebuild_setup_cb = setup_cb;
+    lv_async_call(rebuild_cb, NULL);
+    return true;
+}
+
+void hibernate_bench(hibernate_setup_cb_t setup_cb, uint8_t ui)
+{
+    // cold start: widgets created and drawn
+    uint32_t start = get_time_us();
+    setup_cb(ui);
+    lv_refr_now(NULL);
+    uint32_t cold_us = get_time_us() - start;
+    uint16_t objs = lv_obj_count_children_recursive(lv_scr_act());
+
+    start = get_time_us();
+    if (!hibernate_save())
+        return;
+    uint32_t save_us = get_time_us() - start;
+    uint32_t size = sizeof(header_t) + ((header_t *)blob)->frame_size;
+
+    // resume: read, decoded and presented
+    uint32_t sum_us = 0, max_us = 0;
+    for (uint16_t i = 0; i < HIBERNATE_BENCH_RUNS; i++)
+    {
+        header_t hdr;
+        start = get_time_us();
+        if (!load(&hdr))
+            return;
+        uint32_t us = get_time_us() - start;
+        sum_us += us;
+        max_us = LV_MATH_MAX(max_us, us);
+    }
+    remove(HIBERNATE_FILE);
+
+    MY_LOG("Hibernate bench: cold start %d us (%d objects), save %d us (%d bytes), resume %d us (max. %d us) to the first pixel",
+        cold_us, objs, save_us, size, sum_us / HIBERNATE_BENCH_RUNS, max_us);
+}
+
+#endif // USE_HIBERNATE
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,67 @@
+// ------------------------------------------------------------------------
+// Hibernate: snapshot of the UI state and the last frame, instant resume
+// ------------------------------------------------------------------------
+
+#ifndef __HIBERNATE_H__
+#define __HIBERNATE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lv_drv_conf.h"
+
+// 1: save a snapshot when the window is closed, present it on the next start
+//    (needs the frame copy of sdl_monitor)
+#ifndef USE_HIBERNATE
+#define USE_HIBERNATE 1
+#endif
+#if USE_HIBERNATE && !(USE_MONITOR && MONITOR_PARTIAL_UPLOAD && MONITOR_SHADOW)
+#undef USE_HIBERNATE
+#define USE_HIBERNATE 0
+#endif
+
+#define HIBERNATE_FILE       "hibernate.bin"
+#define HIBERNATE_BENCH_RUNS 20 // resumes timed by hibernate_bench()
+
+// the UIs of main()
+#define HIBERNATE_UI_GUI   0 // setupGui()
+#define HIBERNATE_UI_WATCH 1 // my_watch()
+
+// sets up the UI on the active screen, as on a cold start
+typedef void (*hibernate_setup_cb_t)(uint8_t ui);
+
+#if USE_HIBERNATE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the UI is set up: save a snapshot of it when the window is closed
+void hibernate_init(uint8_t ui);
+
+// write the state of the UI and the last presented frame to HIBERNATE_FILE
+bool hibernate_save(void);
+
+// Instead of a cold start: presents the saved frame at once, then sets up
+// the UI by setup_cb and restores its state before the first refresh. The
+// snapshot is used once. False if there is none (or it does not fit).
+bool hibernate_resume(hibernate_setup_cb_t setup_cb);
+
+// log cold start vs. resume (to the first pixel), the UI stays set up
+void hibernate_bench(hibernate_setup_cb_t setup_cb, uint8_t ui);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define hibernate_init(ui)
+#define hibernate_save() false
+#define hibernate_resume(setup_cb) false
+#define hibernate_bench(setup_cb, ui)
+
+#endif // USE_HIBERNATE
+
+#endif // __HIBERNATE_H__
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,285 @@
+// ------------------------------------------------------------------------
+// Label text fast path: plain text skips the Arabic shaping and bidi detection
+// ------------------------------------------------------------------------
+//
+// With LV_USE_ARABIC_PERSIAN_CHARS, lv_label_set_text() runs every text
+// through _lv_txt_ap_calc_bytecnt() and _lv_txt_ap_proc() (a table lookup
+// per character) into a reallocated buffer; with LV_USE_BIDI and the
+// LV_BIDI_DIR_AUTO default, the base direction is detected from the text on
+// each layout and draw. The clock, date, step and battery texts are ASCII
+// or symbols, so both passes never change anything.
+//
+// Texts without right-to-left or Arabic/Persian code points are thus set as
+// static text from a buffer per label, which LVGL does not shape, with an
+// explicit LTR base direction. A text equal to the current one is skipped
+// altogether, so the label keeps its layout and is not invalidated. The
+// per-line bidi pass of lv_draw_label() itself is inside LVGL and remains.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "label_fast.h"
+#include "app_arena.h"
+
+#if USE_LABEL_FAST
+
+#include <stdarg.h>
+
+typedef struct
+{
+    lv_obj_t *label;                   // NULL: unused
+    lv_signal_cb_t ancestor_signal;
+    char *buf;                         // static text of the label
+    uint16_t size;
+    uint8_t base_dir;                  // as set by the app
+    bool ltr;                          // base direction set to LTR here
+} entry_t;
+
+static entry_t entries[LABEL_FAST_MAX_LABELS];
+static label_fast_stats_t stats;
+static bool enabled = true;
+
+static lv_task_t *report_task;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static inline bool is_rtl_or_shaped(uint32_t cp)
+{
+    return ((cp >= 0x0590) && (cp <= 0x08FF))  // Hebrew, Arabic, Syriac, Thaana, N'Ko, ...
+        || ((cp >= 0xFB1D) && (cp <= 0xFDFF))  // presentation forms
+        || ((cp >= 0xFE70) && (cp <= 0xFEFF))
+        || (cp == 0x200F) || (cp == 0x202B) || (cp == 0x202E) || (cp == 0x2067); // RTL mark, embedding, override, isolate
+}
+
+static entry_t *find_entry(const lv_obj_t *label)
+{
+    for (uint16_t i = 0; i < LABEL_FAST_MAX_LABELS; i++)
+    {
+        if (entries[i].label == label)
+            return &entries[i];
+    }
+    return NULL;
+}
+
+static lv_res_t label_fast_signal(lv_obj_t *label, lv_signal_t sign, void *param)
+{
+    entry_t *e = find_entry(label);
+    lv_res_t res = e->ancestor_signal(label, sign, param);
+
+    if (sign == LV_SIGNAL_CLEANUP)
+    {
+        // LVGL does not free static text
+        if (e->buf)
+            lv_mem_free(e->buf);
+        memset(e, 0, sizeof(entry_t));
+    }
+    return res;
+}
+
+static void report_task_cb(lv_task_t *task)
+{
+    label_fast_report();
+}
+
+static entry_t *add_entry(lv_obj_t *label)
+{
+    entry_t *e = find_entry(NULL);
+    if (!e)
+        return NULL;
+
+    e->label = label;
+    e->ancestor_signal = lv_obj_get_signal_cb(label);
+    e->base_dir = label->base_dir;
+    lv_obj_set_signal_cb(label, label_fast_signal);
+    return e;
+}
+
+static void set_ltr(lv_obj_t *label, entry_t *e)
+{
+    if (!e->ltr && (lv_obj_get_base_dir(label) == LV_BIDI_DIR_AUTO))
+    {
+        lv_obj_set_base_dir(label, LV_BIDI_DIR_LTR);
+        e->ltr = true;
+    }
+}
+
+static bool set_plain(lv_obj_t *label, const char *text)
+{
+    entry_t *e = find_entry(label);
+    if (!e)
+        e = add_entry(label);
+    if (!e)
+        return false;
+
+    size_t size = strlen(text) + 1;
+    if (size > e->size)
+    {
+        char *buf = (char *)lv_mem_realloc(e->buf, size);
+        if (!buf)
+            return false;
+        e->buf = buf;
+        e->size = (uint16_t)size;
+    }
+    memcpy(e->buf, text, size);
+
+    set_ltr(label, e);
+    lv_label_set_static_text(label, e->buf);
+    return true;
+}
+
+static void set_complex(lv_obj_t *label, const char *text)
+{
+    entry_t *e = find_entry(label);
+    if (e && e->ltr)
+    {
+        lv_obj_set_base_dir(label, (lv_bidi_dir_t)e->base_dir);
+        e->ltr = false;
+    }
+    lv_label_set_text(label, text);
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+bool label_fast_is_plain(const char *text)
+{
+    const char *p = text;
+    while (*p && !(*p & 0x80))
+        p++;
+    if (!*p)
+        return true; // ASCII
+
+    uint32_t i = (uint32_t)(p - text);
+    uint32_t cp;
+    while ((cp = _lv_txt_encoded_next(text, &i)) != 0)
+    {
+        if (is_rtl_or_shaped(cp))
+            return false;
+    }
+    return true;
+}
+
+void label_fast_set_text(lv_obj_t *label, const char *text)
+{
+    uint32_t start = get_time_us();
+
+#if LABEL_FAST_REPORT_PERIOD
+    if (!report_task)
+    {
+        app_arena_begin(NULL); // outlives the screen being populated
+        report_task = lv_task_create(report_task_cb, LABEL_FAST_REPORT_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+        app_arena_end();
+    }
+#endif
+
+    if (!enabled)
+    {
+        lv_label_set_text(label, text);
+        stats.lvgl++;
+        stats.lvgl_time_us += get_time_us() - start;
+        return;
+    }
+
+    const char *cur = lv_label_get_text(label);
+    if (text && cur && !strcmp(text, cur))
+        stats.same++;
+    else if (text && label_fast_is_plain(text) && set_plain(label, text))
+        stats.plain++;
+    else
+    {
+        set_complex(label, text);
+        stats.complex++;
+    }
+
+    stats.time_us += get_time_us() - start;
+}
+
+void label_fast_set_static_text(lv_obj_t *label, const char *text)
+{
+    uint32_t start = get_time_us();
+
+    entry_t *e = NULL;
+    if (enabled && label_fast_is_plain(text))
+    {
+        e = find_entry(label);
+        if (!e)
+            e = add_entry(label); // no buffer
+    }
+
+    if (e)
+    {
+        set_ltr(label, e);
+        lv_label_set_static_text(label, text);
+        stats.plain++;
+        stats.time_us += get_time_us() - start;
+    }
+    else
+    {
+        set_complex(label, text); // copied and shaped
+        if (enabled)
+        {
+            stats.complex++;
+            stats.time_us += get_time_us() - start;
+        }
+        else
+        {
+            stats.lvgl++;
+            stats.lvgl_time_us += get_time_us() - start;
+        }
+    }
+}
+
+void label_fast_set_text_fmt(lv_obj_t *label, const char *fmt, ...)
+{
+    char text[LABEL_FAST_FMT_LEN];
+
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    if (len < 0)
+        return;
+    if (len < (int)sizeof(text))
+    {
+        label_fast_set_text(label, text);
+        return;
+    }
+
+    char *long_text = (char *)lv_mem_alloc(len + 1);
+    if (!long_text)
+        return;
+    va_start(args, fmt);
+    vsnprintf(long_text, len + 1, fmt, args);
+    va_end(args);
+
+    label_fast_set_text(label, long_text);
+    lv_mem_free(long_text);
+}
+
+void label_fast_enable(bool enable)
+{
+    enabled = enable;
+}
+
+void label_fast_get_stats(label_fast_stats_t *stats_p)
+{
+    *stats_p = stats;
+}
+
+void label_fast_report(void)
+{
+    uint32_t texts = stats.same + stats.plain + stats.complex;
+    if (texts)
+        MY_LOG("Label texts: %d same, %d plain, %d complex, %d us (%d ns per text)",
+            stats.same, stats.plain, stats.complex, stats.time_us, stats.time_us * 1000 / texts);
+    if (stats.lvgl)
+        MY_LOG("Label texts: %d by lv_label_set_text, %d us (%d ns per text)",
+            stats.lvgl, stats.lvgl_time_us, stats.lvgl_time_us * 1000 / stats.lvgl);
+}
+
+#endif // USE_LABEL_FAST
+
+// ------------------------------------------------------------------------
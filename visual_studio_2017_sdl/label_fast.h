@@ -0,0 +1,71 @@
+// ------------------------------------------------------------------------
+// Label text fast path: plain text skips the Arabic shaping and bidi detection
+// ------------------------------------------------------------------------
+
+#ifndef __LABEL_FAST_H__
+#define __LABEL_FAST_H__
+
+// 1: set plain (left-to-right, unshaped) label texts as static text,
+//    skip texts identical to the current one
+#ifndef USE_LABEL_FAST
+#define USE_LABEL_FAST 1
+#endif
+
+#define LABEL_FAST_MAX_LABELS   16    // labels with a text buffer
+#define LABEL_FAST_FMT_LEN      64    // formatted on the stack, longer texts on the heap
+#define LABEL_FAST_REPORT_PERIOD 0     // ms, 0: no periodic report
+
+#if USE_LABEL_FAST
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t same;       // identical text, skipped
+    uint32_t plain;      // fast path
+    uint32_t complex;    // RTL or Arabic/Persian letters, lv_label_set_text
+    uint32_t time_us;    // spent in label_fast_set_text
+    uint32_t lvgl;       // with the fast path disabled
+    uint32_t lvgl_time_us;
+} label_fast_stats_t;
+
+// true if text has no right-to-left or Arabic/Persian code points,
+// i.e. needs neither shaping nor reordering
+bool label_fast_is_plain(const char *text);
+
+// As lv_label_set_text(): plain text is copied to a buffer kept per label and
+// set as static text, and the label's base direction is set to LTR if it would
+// be detected (LV_BIDI_DIR_AUTO). Text identical to the current one is skipped,
+// so the label keeps its layout. Labels must not use LV_LABEL_LONG_DOT.
+void label_fast_set_text(lv_obj_t *label, const char *text);
+void label_fast_set_text_fmt(lv_obj_t *label, const char *fmt, ...);
+
+// As label_fast_set_text(), but plain text is set from text itself, which
+// must stay valid (e.g. a LabelText buffer). Not skipped if identical.
+void label_fast_set_static_text(lv_obj_t *label, const char *text);
+
+// false: always use lv_label_set_text(), for comparison
+void label_fast_enable(bool enable);
+
+void label_fast_get_stats(label_fast_stats_t *stats);
+void label_fast_report(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define label_fast_set_text        lv_label_set_text
+#define label_fast_set_text_fmt    lv_label_set_text_fmt
+#define label_fast_set_static_text lv_label_set_text // shaped copy
+#define label_fast_enable(enable)
+#define label_fast_report()
+
+#endif // USE_LABEL_FAST
+
+#endif // __LABEL_FAST_H__
+
+// ------------------------------------------------------------------------
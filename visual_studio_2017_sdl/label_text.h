@@ -0,0 +1,101 @@
+// ------------------------------------------------------------------------
+// Label text in an inline buffer, formatted without heap allocation
+// ------------------------------------------------------------------------
+
+#ifndef __LABEL_TEXT_H__
+#define __LABEL_TEXT_H__
+
+#include "gui.h"
+#include "label_fast.h"
+#include "tlsf_mem.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// 1: log lv_mem changes across HeapCheck scopes (walks the heap, simulator only)
+#ifndef LABEL_TEXT_HEAP_CHECK
+#define LABEL_TEXT_HEAP_CHECK 0
+#endif
+
+#ifdef __cplusplus
+
+// Text of a label, kept in N bytes owned by the object holding the
+// LabelText (e.g. an app), and set as static text. A formatted text is
+// written to the stack and compared first: an identical text leaves the
+// label untouched (no layout, no invalidation). Longer texts are truncated.
+// The text of the label must only be set through its LabelText.
+template <size_t N>
+class LabelText
+{
+public:
+    LabelText() : label(NULL), valid(false) { text[0] = '\0'; }
+
+    void attach(lv_obj_t *obj)
+    {
+        label = obj;
+        valid = false;
+    }
+
+    // return true if the text changed
+    bool setText(const char *txt)
+    {
+        if (valid && !strcmp(txt, text))
+            return false;
+
+        strncpy(text, txt, N - 1);
+        text[N - 1] = '\0';
+        valid = true;
+        label_fast_set_static_text(label, text); // not shaped if plain
+        return true;
+    }
+
+    bool setTextFmt(const char *fmt, ...)
+    {
+        char buf[N];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(buf, N, fmt, args);
+        va_end(args);
+        return setText(buf);
+    }
+
+    const char *getText() const { return text; }
+
+private:
+    lv_obj_t *label;
+    bool valid;            // text is shown by label
+    char text[N];
+};
+
+// Logs if the lv_mem heap differs at the end of the scope from its start,
+// e.g. HeapCheck check("updateTime"); An allocation freed within the scope
+// is not detected.
+class HeapCheck
+{
+public:
+#if LABEL_TEXT_HEAP_CHECK
+    HeapCheck(const char *scope_name) : name(scope_name) { mem_monitor(&before); }
+
+    ~HeapCheck()
+    {
+        lv_mem_monitor_t after;
+        mem_monitor(&after);
+        if ((after.used_cnt != before.used_cnt) || (after.free_size != before.free_size))
+            MY_LOG("Heap traffic in %s: %d -> %d blocks, %d -> %d bytes free", name,
+                before.used_cnt, after.used_cnt, before.free_size, after.free_size);
+    }
+
+private:
+    const char *name;
+    lv_mem_monitor_t before;
+#else
+    HeapCheck(const char *scope_name) {}
+#endif
+};
+
+#endif // __cplusplus
+
+#endif // __LABEL_TEXT_H__
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,595 @@
+// ------------------------------------------------------------------------
+// Retained layers: static widgets are redrawn from an offscreen bitmap
+// ------------------------------------------------------------------------
+//
+// The calendar draws 42 date cells, the day names and the header; it is
+// redrawn whenever a tile slides over it or anything near it is invalidated,
+// although its content changes once a day.
+//
+// The design callback of a retained object is wrapped. After the object and
+// its children have been drawn (LV_DESIGN_DRAW_POST), the tiles fully inside
+// the clip area which the object covers (opaque background, see its
+// LV_DESIGN_COVER_CHK) are copied from the display buffer into the bitmap of
+// the object and marked valid. Their pixels do not depend on what is below,
+// only on the object and its children. LV_DESIGN_DRAW_MAIN copies the valid
+// tiles back and draws the rest only (all or nothing with children, which
+// are skipped then: hidden until LV_DESIGN_DRAW_POST).
+//
+// Invalidated areas are seen one by one, before LVGL drops those within a
+// saved one, by wrapping the rounder of the display driver. Only the areas
+// within the visible part of the object can come from it or its children
+// and make tiles invalid; larger ones are from a parent or a screen load, a
+// sibling below is covered, one above is drawn after the capture. The
+// bitmap is shifted along when the object moves (e.g. the tileview is
+// swiped) and rendered again when it is resized. Tiles not visible at a
+// refresh become invalid (LVGL drops the invalidations there), all of them
+// if a parent changes a local style (inherited properties are not
+// signalled) or runs a style transition.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "layer_cache.h"
+
+#if USE_LAYER_CACHE
+
+#include <stdlib.h>
+
+typedef struct
+{
+    lv_obj_t *obj;                 // NULL: unused
+    lv_signal_cb_t ancestor_signal;
+    lv_design_cb_t ancestor_design;
+    lv_area_t area;                // of the bitmap: coords
+    lv_color_t *buf;
+    uint32_t size;
+    uint8_t tiles_x, tiles_y;
+    uint8_t valid[LAYER_CACHE_MAX_TILES / 8];
+    uint32_t parents_sig;          // local styles of the parents
+    lv_obj_t *hidden[LAYER_CACHE_MAX_CHILDREN];
+    uint8_t num_hidden;
+    bool copied;                   // all by the last LV_DESIGN_DRAW_MAIN
+    lv_area_t drawn[LAYER_CACHE_MAX_DRAWN]; // the rest of it
+    uint8_t num_drawn;
+} entry_t;
+
+static entry_t entries[LAYER_CACHE_MAX_OBJS];
+static layer_cache_stats_t stats;
+
+static lv_task_cb_t refr_task_cb; // original
+static void (*rounder_cb)(lv_disp_drv_t *disp_drv, lv_area_t *area); // original
+static bool refreshing;
+static lv_task_t *report_task;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static entry_t *find_entry(const lv_obj_t *obj)
+{
+    for (uint16_t i = 0; i < LAYER_CACHE_MAX_OBJS; i++)
+    {
+        if (entries[i].obj == obj)
+            return &entries[i];
+    }
+    return NULL;
+}
+
+static void free_buf(entry_t *e)
+{
+    if (e->buf)
+    {
+        LAYER_CACHE_FREE(e->buf);
+        stats.bytes -= e->size;
+    }
+    e->buf = NULL;
+    e->size = 0;
+}
+
+static void invalidate_all(entry_t *e)
+{
+    memset(e->valid, 0, sizeof(e->valid));
+}
+
+static bool is_valid(const entry_t *e, uint16_t i)
+{
+    return (e->valid[i / 8] & (1 << (i % 8))) != 0;
+}
+
+static void get_tile(const entry_t *e, uint8_t tx, uint8_t ty, lv_area_t *tile)
+{
+    tile->x1 = e->area.x1 + tx * LAYER_CACHE_TILE;
+    tile->y1 = e->area.y1 + ty * LAYER_CACHE_TILE;
+    tile->x2 = LV_MATH_MIN(tile->x1 + LAYER_CACHE_TILE - 1, e->area.x2); // at the right and bottom edge
+    tile->y2 = LV_MATH_MIN(tile->y1 + LAYER_CACHE_TILE - 1, e->area.y2);
+}
+
+// tiles overlapping the area become invalid
+static void invalidate_tiles(entry_t *e, const lv_area_t *area)
+{
+    lv_area_t a;
+    if ((e->tiles_x * e->tiles_y > LAYER_CACHE_MAX_TILES) || !_lv_area_intersect(&a, area, &e->area))
+        return;
+
+    for (uint8_t ty = (a.y1 - e->area.y1) / LAYER_CACHE_TILE; ty <= (a.y2 - e->area.y1) / LAYER_CACHE_TILE; ty++)
+    {
+        for (uint8_t tx = (a.x1 - e->area.x1) / LAYER_CACHE_TILE; tx <= (a.x2 - e->area.x1) / LAYER_CACHE_TILE; tx++)
+        {
+            uint16_t i = ty * e->tiles_x + tx;
+            e->valid[i / 8] &= ~(1 << (i % 8));
+        }
+    }
+}
+
+// tiles not within the area become invalid
+static void keep_tiles(entry_t *e, const lv_area_t *area)
+{
+    if (e->tiles_x * e->tiles_y > LAYER_CACHE_MAX_TILES)
+        return;
+
+    for (uint8_t ty = 0; ty < e->tiles_y; ty++)
+    {
+        for (uint8_t tx = 0; tx < e->tiles_x; tx++)
+        {
+            lv_area_t tile;
+            get_tile(e, tx, ty, &tile);
+            if (!_lv_area_is_in(&tile, area, 0))
+            {
+                uint16_t i = ty * e->tiles_x + tx;
+                e->valid[i / 8] &= ~(1 << (i % 8));
+            }
+        }
+    }
+}
+
+static bool all_valid(const entry_t *e, const lv_area_t *area)
+{
+    if (!e->buf || !_lv_area_is_in(area, &e->area, 0))
+        return false;
+
+    for (uint8_t ty = (area->y1 - e->area.y1) / LAYER_CACHE_TILE; ty <= (area->y2 - e->area.y1) / LAYER_CACHE_TILE; ty++)
+    {
+        for (uint8_t tx = (area->x1 - e->area.x1) / LAYER_CACHE_TILE; tx <= (area->x2 - e->area.x1) / LAYER_CACHE_TILE; tx++)
+        {
+            if (!is_valid(e, ty * e->tiles_x + tx))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Moved: the bitmap is shifted along (its pixels only depend on the object).
+// Resized: all tiles invalid, bitmap of the new size.
+static void update_area(entry_t *e)
+{
+    const lv_area_t *area = &e->obj->coords;
+    if ((lv_area_get_width(area) == lv_area_get_width(&e->area)) && (lv_area_get_height(area) == lv_area_get_height(&e->area)))
+    {
+        lv_area_copy(&e->area, area);
+        return;
+    }
+
+    invalidate_all(e);
+    free_buf(e);
+    lv_area_copy(&e->area, area);
+    e->tiles_x = (uint8_t)((lv_area_get_width(area) + LAYER_CACHE_TILE - 1) / LAYER_CACHE_TILE);
+    e->tiles_y = (uint8_t)((lv_area_get_height(area) + LAYER_CACHE_TILE - 1) / LAYER_CACHE_TILE);
+}
+
+// As lv_obj_invalidate_area(): the part of the object (with its extra draw
+// area or not) clipped by the parents and the screen. False if none, also
+// if hidden or not on a shown screen: invalidations are dropped then.
+static bool get_visible(const lv_obj_t *obj, lv_coord_t pad, lv_area_t *vis)
+{
+    lv_disp_t *disp = lv_obj_get_disp(obj);
+    lv_obj_t *scr = lv_obj_get_screen(obj);
+    if ((scr != lv_disp_get_scr_act(disp)) && (scr != lv_disp_get_scr_prev(disp)) &&
+        (scr != lv_disp_get_layer_top(disp)) && (scr != lv_disp_get_layer_sys(disp)))
+        return false;
+
+    lv_area_t scr_area;
+    lv_area_set(&scr_area, 0, 0, lv_disp_get_hor_res(disp) - 1, lv_disp_get_ver_res(disp) - 1);
+    lv_area_copy(vis, &obj->coords);
+    vis->x1 -= pad;
+    vis->y1 -= pad;
+    vis->x2 += pad;
+    vis->y2 += pad;
+    if (obj->hidden || !_lv_area_intersect(vis, vis, &scr_area))
+        return false;
+
+    for (const lv_obj_t *par = lv_obj_get_parent(obj); par; par = lv_obj_get_parent(par))
+    {
+        if (par->hidden || !_lv_area_intersect(vis, vis, &par->coords))
+            return false;
+    }
+    return true;
+}
+
+// Local styles of the parents' main parts, where inherited properties come
+// from; setting one that is not layout relevant only invalidates the parent.
+// False while a parent runs a style transition.
+static bool get_parents_sig(const lv_obj_t *obj, uint32_t *sig)
+{
+    *sig = 0;
+    for (const lv_obj_t *par = lv_obj_get_parent(obj); par; par = lv_obj_get_parent(par))
+    {
+        lv_style_list_t *list = lv_obj_get_style_list(par, LV_OBJ_PART_MAIN);
+        if (!list)
+            continue;
+        if (list->has_trans)
+            return false;
+
+        lv_style_t *local = lv_style_list_get_local_style(list);
+        *sig = *sig * 31 + (uint32_t)(uintptr_t)(local ? local->map : NULL);
+        if (!local || !local->map)
+            continue;
+
+        uint16_t size = _lv_style_get_mem_size(local);
+        for (uint16_t i = 0; i < size; i++)
+            *sig = *sig * 31 + local->map[i];
+    }
+    return true;
+}
+
+static bool alloc_buf(entry_t *e)
+{
+    if (e->buf)
+        return true;
+    if (e->tiles_x * e->tiles_y > LAYER_CACHE_MAX_TILES)
+        return false;
+
+    uint32_t size = lv_area_get_size(&e->area) * sizeof(lv_color_t);
+    if (stats.bytes + size > LAYER_CACHE_MAX_BYTES)
+        return false;
+
+    e->buf = (lv_color_t *)LAYER_CACHE_ALLOC(size);
+    if (!e->buf)
+        return false;
+    e->size = size;
+    stats.bytes += size;
+    return true;
+}
+
+// from the display buffer to the bitmap (to_buf) or back
+static void copy(entry_t *e, const lv_area_t *clip, bool to_buf)
+{
+    lv_disp_buf_t *vdb = lv_disp_get_buf(_lv_refr_get_disp_refreshing());
+    lv_coord_t vdb_w = lv_area_get_width(&vdb->area);
+    lv_coord_t buf_w = lv_area_get_width(&e->area);
+    size_t len = lv_area_get_width(clip) * sizeof(lv_color_t);
+
+    lv_color_t *vdb_p = (lv_color_t *)vdb->buf_act + (clip->y1 - vdb->area.y1) * vdb_w + (clip->x1 - vdb->area.x1);
+    lv_color_t *buf_p = e->buf + (clip->y1 - e->area.y1) * buf_w + (clip->x1 - e->area.x1);
+    for (lv_coord_t y = clip->y1; y <= clip->y2; y++)
+    {
+        if (to_buf)
+            memcpy(buf_p, vdb_p, len);
+        else
+            memcpy(vdb_p, buf_p, len);
+        vdb_p += vdb_w;
+        buf_p += buf_w;
+    }
+}
+
+// the valid tiles are copied, the rest of the clip area is left to be drawn
+// (per tile row, from the first to the last invalid tile)
+static uint32_t copy_valid(entry_t *e, const lv_area_t *clip)
+{
+    e->num_drawn = 0;
+    lv_area_t in;
+    if (!_lv_area_intersect(&in, clip, &e->area))
+        return 0;
+
+    // extra draw area around the bitmap
+    lv_area_t pad[4];
+    uint8_t num_pad = 0;
+    if (clip->y1 < in.y1)
+        lv_area_set(&pad[num_pad++], clip->x1, clip->y1, clip->x2, in.y1 - 1);
+    if (clip->y2 > in.y2)
+        lv_area_set(&pad[num_pad++], clip->x1, in.y2 + 1, clip->x2, clip->y2);
+    if (clip->x1 < in.x1)
+        lv_area_set(&pad[num_pad++], clip->x1, in.y1, in.x1 - 1, in.y2);
+    if (clip->x2 > in.x2)
+        lv_area_set(&pad[num_pad++], in.x2 + 1, in.y1, clip->x2, in.y2);
+    for (uint8_t i = 0; i < num_pad; i++)
+        e->drawn[e->num_drawn++] = pad[i];
+
+    uint8_t tx1 = (in.x1 - e->area.x1) / LAYER_CACHE_TILE, tx2 = (in.x2 - e->area.x1) / LAYER_CACHE_TILE;
+    uint8_t ty1 = (in.y1 - e->area.y1) / LAYER_CACHE_TILE, ty2 = (in.y2 - e->area.y1) / LAYER_CACHE_TILE;
+    uint32_t copied_px = 0;
+    for (uint8_t ty = ty1; ty <= ty2; ty++)
+    {
+        lv_area_t span;
+        bool invalid = false;
+        for (uint8_t tx = tx1; tx <= tx2; tx++)
+        {
+            lv_area_t tile, t;
+            get_tile(e, tx, ty, &tile);
+            _lv_area_intersect(&t, &tile, &in);
+            if (!is_valid(e, ty * e->tiles_x + tx))
+            {
+                if (!invalid)
+                    lv_area_copy(&span, &t);
+                span.x2 = t.x2;
+                invalid = true;
+                continue;
+            }
+            copy(e, &t, false);
+            copied_px += lv_area_get_size(&t);
+        }
+
+        if (invalid)
+        {
+            if (e->num_drawn >= LAYER_CACHE_MAX_DRAWN)
+            {
+                // too fragmented: all of it is drawn
+                e->num_drawn = 0;
+                return 0;
+            }
+            e->drawn[e->num_drawn++] = span;
+        }
+    }
+    return copied_px;
+}
+
+// the tiles fully drawn in the clip area which the object covers
+static void capture(entry_t *e, const lv_area_t *clip)
+{
+    lv_area_t in;
+    if (!_lv_area_intersect(&in, clip, &e->area) || !alloc_buf(e))
+        return;
+
+    bool captured = false;
+    for (uint8_t ty = (in.y1 - e->area.y1) / LAYER_CACHE_TILE; ty <= (in.y2 - e->area.y1) / LAYER_CACHE_TILE; ty++)
+    {
+        for (uint8_t tx = (in.x1 - e->area.x1) / LAYER_CACHE_TILE; tx <= (in.x2 - e->area.x1) / LAYER_CACHE_TILE; tx++)
+        {
+            uint16_t i = ty * e->tiles_x + tx;
+            lv_area_t tile;
+            get_tile(e, tx, ty, &tile);
+            if (is_valid(e, i) || !_lv_area_is_in(&tile, clip, 0) ||
+                (e->ancestor_design(e->obj, &tile, LV_DESIGN_COVER_CHK) != LV_DESIGN_RES_COVER))
+                continue;
+
+            copy(e, &tile, true);
+            e->valid[i / 8] |= (1 << (i % 8));
+            captured = true;
+        }
+    }
+    stats.captures += captured;
+}
+
+static void show_children(entry_t *e)
+{
+    while (e->num_hidden)
+        e->hidden[--e->num_hidden]->hidden = 0;
+}
+
+// hide the children while the bitmap is copied (they are in it)
+static bool hide_children(entry_t *e)
+{
+    e->num_hidden = 0;
+    for (lv_obj_t *child = lv_obj_get_child(e->obj, NULL); child; child = lv_obj_get_child(e->obj, child))
+    {
+        if (child->hidden)
+            continue;
+        if (e->num_hidden >= LAYER_CACHE_MAX_CHILDREN)
+        {
+            show_children(e);
+            return false;
+        }
+        child->hidden = 1; // without invalidating
+        e->hidden[e->num_hidden++] = child;
+    }
+    return true;
+}
+
+static lv_design_res_t layer_design(lv_obj_t *obj, const lv_area_t *clip_area, lv_design_mode_t mode)
+{
+    entry_t *e = find_entry(obj);
+
+    if (mode == LV_DESIGN_COVER_CHK)
+    {
+        if (all_valid(e, clip_area))
+            return LV_DESIGN_RES_COVER;
+        return e->ancestor_design(obj, clip_area, mode);
+    }
+
+    if (mode == LV_DESIGN_DRAW_MAIN)
+    {
+        e->copied = false;
+        e->num_drawn = 0;
+        uint32_t copied_px = 0;
+        if (e->buf && (lv_draw_mask_get_cnt() == 0))
+        {
+            if (lv_obj_get_child(obj, NULL))
+            {
+                e->copied = all_valid(e, clip_area) && hide_children(e);
+                if (e->copied)
+                    copy(e, clip_area, false);
+            }
+            else
+            {
+                copied_px = copy_valid(e, clip_area);
+                e->copied = copied_px && !e->num_drawn;
+            }
+        }
+
+        if (e->copied)
+        {
+            stats.hits++;
+            stats.hit_px += lv_area_get_size(clip_area);
+            return LV_DESIGN_RES_OK;
+        }
+
+        stats.misses++;
+        if (!copied_px)
+        {
+            e->num_drawn = 0;
+            stats.miss_px += lv_area_get_size(clip_area);
+            return e->ancestor_design(obj, clip_area, mode);
+        }
+
+        stats.hit_px += copied_px;
+        stats.miss_px += lv_area_get_size(clip_area) - copied_px;
+        for (uint8_t i = 0; i < e->num_drawn; i++)
+            e->ancestor_design(obj, &e->drawn[i], mode);
+        return LV_DESIGN_RES_OK;
+    }
+
+    // LV_DESIGN_DRAW_POST
+    if (e->copied)
+    {
+        show_children(e);
+        e->copied = false;
+        return LV_DESIGN_RES_OK;
+    }
+
+    lv_design_res_t res = LV_DESIGN_RES_OK;
+    if (e->num_drawn)
+    {
+        for (uint8_t i = 0; i < e->num_drawn; i++)
+            e->ancestor_design(obj, &e->drawn[i], mode);
+        e->num_drawn = 0;
+    }
+    else
+        res = e->ancestor_design(obj, clip_area, mode);
+
+    if (lv_draw_mask_get_cnt() == 0)
+        capture(e, clip_area);
+    return res;
+}
+
+static lv_res_t layer_signal(lv_obj_t *obj, lv_signal_t sign, void *param)
+{
+    entry_t *e = find_entry(obj);
+    lv_res_t res = e->ancestor_signal(obj, sign, param);
+
+    if (sign == LV_SIGNAL_STYLE_CHG)
+        invalidate_all(e);
+    else if (sign == LV_SIGNAL_CLEANUP)
+    {
+        free_buf(e);
+        memset(e, 0, sizeof(entry_t));
+    }
+    return res;
+}
+
+// each invalidated area, before it is saved (or dropped as within a saved one)
+static void layer_rounder(lv_disp_drv_t *disp_drv, lv_area_t *area)
+{
+    // also called by the refresh to round the rows of the display buffer
+    for (uint16_t i = 0; (i < LAYER_CACHE_MAX_OBJS) && !refreshing; i++)
+    {
+        entry_t *e = &entries[i];
+        lv_area_t vis;
+        if (e->obj && get_visible(e->obj, e->obj->ext_draw_pad, &vis) && _lv_area_is_in(area, &vis, 0))
+        {
+            update_area(e);
+            invalidate_tiles(e, area);
+        }
+    }
+
+    if (rounder_cb)
+        rounder_cb(disp_drv, area);
+}
+
+static void refr_task(lv_task_t *task)
+{
+    for (uint16_t i = 0; i < LAYER_CACHE_MAX_OBJS; i++)
+    {
+        entry_t *e = &entries[i];
+        if (!e->obj)
+            continue;
+
+        update_area(e);
+        uint32_t sig;
+        lv_area_t vis;
+        if (!get_parents_sig(e->obj, &sig) || (sig != e->parents_sig) || !get_visible(e->obj, 0, &vis))
+            invalidate_all(e);
+        else
+            keep_tiles(e, &vis);
+        e->parents_sig = sig;
+    }
+
+    refreshing = true;
+    refr_task_cb(task);
+    refreshing = false;
+}
+
+static void report_task_cb(lv_task_t *task)
+{
+    layer_cache_report();
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+void layer_cache_init(lv_disp_t *disp)
+{
+    if (!disp || !disp->refr_task || (disp->refr_task->task_cb == refr_task))
+        return;
+
+    refr_task_cb = disp->refr_task->task_cb;
+    disp->refr_task->task_cb = refr_task;
+    rounder_cb = disp->driver.rounder_cb;
+    disp->driver.rounder_cb = layer_rounder;
+
+#if LAYER_CACHE_REPORT_PERIOD
+    if (!report_task)
+        report_task = lv_task_create(report_task_cb, LAYER_CACHE_REPORT_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+#endif
+}
+
+bool layer_cache_enable(lv_obj_t *obj)
+{
+    if (find_entry(obj))
+        return true;
+
+    entry_t *e = find_entry(NULL);
+    if (!e)
+    {
+        MY_LOG("Layer cache: no free entry");
+        return false;
+    }
+
+    e->obj = obj;
+    e->ancestor_signal = lv_obj_get_signal_cb(obj);
+    e->ancestor_design = lv_obj_get_design_cb(obj);
+    lv_obj_set_signal_cb(obj, layer_signal);
+    lv_obj_set_design_cb(obj, layer_design);
+    update_area(e);
+    return true;
+}
+
+void layer_cache_invalidate(lv_obj_t *obj)
+{
+    entry_t *e = find_entry(obj);
+    if (e)
+        invalidate_all(e);
+}
+
+void layer_cache_get_stats(layer_cache_stats_t *stats_p)
+{
+    *stats_p = stats;
+}
+
+void layer_cache_report(void)
+{
+    uint32_t draws = stats.hits + stats.misses;
+    if (!draws)
+        return;
+
+    uint16_t objs = 0;
+    for (uint16_t i = 0; i < LAYER_CACHE_MAX_OBJS; i++)
+        objs += (entries[i].obj != NULL);
+
+    uint64_t px = (uint64_t)stats.hit_px + stats.miss_px;
+    MY_LOG("Layer cache: %d objects, %d bytes, %d hits (%d px), %d misses (%d px), %d captures, hit rate %d%% (%d%% of px)",
+        objs, stats.bytes, stats.hits, stats.hit_px, stats.misses, stats.miss_px, stats.captures,
+        stats.hits * 100 / draws, (int)(stats.hit_px * 100 / px));
+}
+
+#endif // USE_LAYER_CACHE
+
+// ------------------------------------------------------------------------
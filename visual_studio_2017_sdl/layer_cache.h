@@ -0,0 +1,73 @@
+// ------------------------------------------------------------------------
+// Retained layers: static widgets are redrawn from an offscreen bitmap
+// ------------------------------------------------------------------------
+
+#ifndef __LAYER_CACHE_H__
+#define __LAYER_CACHE_H__
+
+// 1: objects marked by layer_cache_enable() keep their rendered pixels
+#ifndef USE_LAYER_CACHE
+#define USE_LAYER_CACHE 1
+#endif
+
+#define LAYER_CACHE_MAX_OBJS      4
+#define LAYER_CACHE_MAX_BYTES     (512U * 1024U) // all bitmaps
+#define LAYER_CACHE_TILE          16             // px, validity per tile
+#define LAYER_CACHE_MAX_TILES     256            // per object, e.g. 256 x 256 px
+#define LAYER_CACHE_MAX_CHILDREN  8
+#define LAYER_CACHE_MAX_DRAWN     20             // areas drawn around the valid tiles, else all
+#define LAYER_CACHE_REPORT_PERIOD 0              // ms, 0: no periodic report
+
+// bitmaps are too big for the LVGL heap (PSRAM on the watch: ps_malloc)
+#define LAYER_CACHE_ALLOC(size) malloc(size)
+#define LAYER_CACHE_FREE(p)     free(p)
+
+#if USE_LAYER_CACHE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint32_t hits;       // areas copied from the bitmap
+    uint32_t hit_px;
+    uint32_t misses;     // areas drawn, at least partly (and captured)
+    uint32_t miss_px;
+    uint32_t captures;
+    uint32_t bytes;      // allocated for the bitmaps
+} layer_cache_stats_t;
+
+// hook into the refresh task and the rounder of the display (to see the
+// invalidated areas)
+void layer_cache_init(lv_disp_t *disp);
+
+// Retain the rendered object with its children where it covers its area
+// (opaque background; its rounded corners and extra draw area are drawn
+// each time). A tile of the bitmap is rendered again once an area within the
+// object overlapping it is invalidated (by the object, its children or
+// styles, or an object on top), all of it if the object is resized. Moving
+// it, or a parent, keeps the bitmap. Not used while a mask (e.g. a rounded
+// parent clipping its corners) is active.
+bool layer_cache_enable(lv_obj_t *obj);
+void layer_cache_invalidate(lv_obj_t *obj);
+
+void layer_cache_get_stats(layer_cache_stats_t *stats);
+void layer_cache_report(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define layer_cache_init(disp)
+#define layer_cache_enable(obj) false
+#define layer_cache_invalidate(obj)
+#define layer_cache_report()
+
+#endif // USE_LAYER_CACHE
+
+#endif // __LAYER_CACHE_H__
+
+// ------------------------------------------------------------------------
@@ -78,11 +78,16 @@ typedef int16_t lv_coord_t;
 /* LittelvGL's internal memory manager's settings.
  * The graphical objects and other related data are stored here. */
 
+/* 1: TLSF allocator of tlsf_mem.h (O(1) alloc and free) on a pool of LV_MEM_SIZE,
+ * 0: the built-in heap (first fit) */
+#define LV_MEM_TLSF        1
+
+/* Size of the memory used by `lv_mem_alloc` in bytes (>= 2kB)*/
+#define LV_MEM_SIZE    (64U * 1024U)
+
 /* 1: use custom malloc/free, 0: use the built-in `lv_mem_alloc` and `lv_mem_free` */
-#define LV_MEM_CUSTOM      0
+#define LV_MEM_CUSTOM      LV_MEM_TLSF
 #if LV_MEM_CUSTOM == 0
-/* Size of the memory used by `lv_mem_alloc` in bytes (>= 2kB)*/
-#  define LV_MEM_SIZE    (64U * 1024U)
 
 /* Complier prefix for a big array declaration */
 #  define LV_MEM_ATTR
@@ -93,6 +98,10 @@ typedef int16_t lv_coord_t;
 
 /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #  define LV_MEM_AUTO_DEFRAG  1
+#elif LV_MEM_TLSF
+#  define LV_MEM_CUSTOM_INCLUDE "tlsf_mem.h"
+#  define LV_MEM_CUSTOM_ALLOC   tlsf_mem_alloc
+#  define LV_MEM_CUSTOM_FREE    tlsf_mem_free
 #else       /*LV_MEM_CUSTOM*/
 #  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
 #  define LV_MEM_CUSTOM_ALLOC   malloc       /*Wrapper to malloc*/
@@ -311,9 +320,21 @@ typedef void * lv_indev_drv_user_data_t;            /*Type of user data in the i
  * The behavior of asserts can be overwritten by redefining them here.
  * E.g. #define LV_ASSERT_MEM(p)  <my_assert_code>
  */
-#define LV_USE_DEBUG        1
+
+/* Tiers of the checks (see assert_tier.h):
+ * 0: off, 1: cheap checks only (NULL, style),
+ * 2: cheap checks always, slow ones (object, string, heap) sampled,
+ * 3: all checks on every call */
+#define LV_ASSERT_TIER          2
+#define LV_ASSERT_SAMPLE_EVERY  100 /*Slow check on every Nth call of its kind, 0: not by count*/
+#define LV_ASSERT_BUDGET_PCT    0   /*Slow checks while they took less of the time [%], 0: no budget*/
+
+#define LV_USE_DEBUG        (LV_ASSERT_TIER != 0)
 #if LV_USE_DEBUG
 
+/*Replaces the checks below by the tiers*/
+#  include "assert_tier.h"
+
 /*Check if the parameter is NULL. (Quite fast) */
 #define LV_USE_ASSERT_NULL      1
 
@@ -347,6 +368,11 @@ typedef void * lv_indev_drv_user_data_t;            /*Type of user data in the i
  * To create a new font go to: https://lvgl.com/ttf-font-to-c-array
  */
 
+/* Watch build profile: only the fonts and glyphs used by the watch UI,
+ * subsetted by fonts/font_subset.py (see fonts/watch_fonts_conf.h) */
+#define LV_WATCH_PROFILE    0
+
+#if LV_WATCH_PROFILE == 0
 /* Montserrat fonts with bpp = 4
  * https://fonts.google.com/specimen/Montserrat  */
 #define LV_FONT_MONTSERRAT_12    1
@@ -372,8 +398,9 @@ typedef void * lv_indev_drv_user_data_t;            /*Type of user data in the i
 /* Demonstrate special features */
 #define LV_FONT_MONTSERRAT_12_SUBPX      1
 #define LV_FONT_MONTSERRAT_28_COMPRESSED 1  /*bpp = 3*/
-#define LV_FONT_DEJAVU_16_PERSIAN_HEBREW 1  /*Hebrew, Arabic, PErisan letters and all their forms*/
-#define LV_FONT_SIMSUN_16_CJK            1  /*1000 most common CJK radicals*/
+#define LV_FONT_DEJAVU_16_PERSIAN_HEBREW 0  /*Hebrew, Arabic, PErisan letters and all their forms*/
+#define LV_FONT_SIMSUN_16_CJK            0  /*1000 most common CJK radicals*/
+/* (both rarely shown: loaded from binary font files instead, see font_lazy.h) */
 
 /*Pixel perfect monospace font
  * http://pelulamu.net/unscii/ */
@@ -386,6 +413,9 @@ typedef void * lv_indev_drv_user_data_t;            /*Type of user data in the i
  *                                LV_FONT_DECLARE(my_font_2)
  */
 #define LV_FONT_CUSTOM_DECLARE
+#else
+#include "fonts/watch_fonts_conf.h"
+#endif /*LV_WATCH_PROFILE*/
 
 /* Enable it if you have fonts with a lot of characters.
  * The limit depends on the font size, font face and bpp
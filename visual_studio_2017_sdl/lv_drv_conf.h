@@ -102,6 +102,19 @@
 
 /*Open two windows to test multi display support*/
 #  define MONITOR_DUAL            0
+
+/* Use the simulator's own `sdl_monitor.c` instead of `monitor.c`:
+ * only the flushed areas are uploaded to a streaming texture and
+ * all flushes of one refresh are presented at once.
+ * Requires MONITOR_DOUBLE_BUFFERED = 0 and MONITOR_DUAL = 0 */
+#  define MONITOR_PARTIAL_UPLOAD  1
+
+/* Period of the upload statistics log in ms (0: no log) */
+#  define MONITOR_STATS_PERIOD    0
+
+/* 1: keep a copy of the presented frame (`sdl_monitor_get_frame`),
+ * e.g. to be saved when hibernating */
+#  define MONITOR_SHADOW          1
 #endif
 
 /*-----------------------------------
@@ -11,12 +11,24 @@
 #include <SDL.h>
 #include "lvgl/lvgl.h"
 #include "lv_drivers/display/monitor.h"
+#include "sdl_monitor.h"
 #include "lv_drivers/indev/mouse.h"
 #include "lv_drivers/indev/keyboard.h"
 #include "lv_examples/lv_examples.h"
 
 #include "my_watch.h"
 #include "gui.h"
+#include "overdraw.h"
+#include "area_merge.h"
+#include "font_cache.h"
+#include "draw_cache.h"
+#include "layer_cache.h"
+#include "tlsf_mem.h"
+#include "mem_telemetry.h"
+#include "mem_profile.h"
+#include "soak_bench.h"
+#include "assert_tier.h"
+#include "hibernate.h"
 
 /*********************
 *      DEFINES
@@ -31,6 +43,8 @@
 **********************/
 static void hal_init(void);
 static int tick_thread(void *data);
+static void monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px);
+static void setup_ui(uint8_t ui);
 
 /**********************
 *  STATIC VARIABLES
@@ -39,6 +53,8 @@ static lv_indev_t * kb_indev;
 
 static DWORD sleep_ms = 10; // default
 
+static uint32_t boot_us; // 0: first frame done
+
 /**********************
 *      MACROS
 **********************/
@@ -68,7 +84,21 @@ uint16_t get_bat_level(void)
 
 uint32_t get_free_mem(void)
 {
-    return 0; // not implemented
+    mem_sample_t s;
+    if (!mem_telemetry_get(0, &s))
+        s = *mem_telemetry_sample();
+    return s.free_size;
+}
+
+uint32_t get_time_us(void)
+{
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER cnt;
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&cnt);
+    return (uint32_t)((cnt.QuadPart / freq.QuadPart) * 1000000 +
+                      (cnt.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart);
 }
 
 void play_sound(void)
@@ -87,6 +117,22 @@ void get_accel(lv_point_t *dir)
     dir->y = 50 * cos(0.005*curr_ms);
 }
 
+// simulated scan: each network is reported by several access points
+static void wifi_scan_task(lv_task_t *task)
+{
+    static uint16_t reports = 0;
+    char ssid[16];
+
+    for (int i = 0; i < 8; i++)
+    {
+        snprintf(ssid, sizeof(ssid), "WLAN-%03d", rand() % 300);
+        wifi_list_add(ssid);
+    }
+
+    if (++reports >= 100)
+        lv_task_del(task);
+}
+
 void ntp_sync_time(void)
 {
   // not implemented	
@@ -105,11 +151,16 @@ void set_high_speed(void)
 
 int main(int argc, char** argv)
 {
+    boot_us = get_time_us();
+
     /*Initialize LittlevGL*/
     lv_init();
 
     /*Initialize the HAL for LittlevGL*/
     hal_init();
+    mem_telemetry_init();
+    mem_profile_init();
+    assert_tier_init();
 
     /*
      * Demos, benchmarks, and tests.
@@ -118,23 +169,27 @@ int main(int argc, char** argv)
      * item.
      */
 
-    if (1)
+    if (0)
     {
-        setupGui();
-        updateBatteryLevel();
-        updateStepCounter(123);
-        update_time(true);
-
-        lv_disp_trig_activity(NULL);
+        soak_bench(); // both watch UIs, then the second one stays
+    }
+    else if (0)
+    {
+        hibernate_bench(setup_ui, HIBERNATE_UI_GUI);
+    }
+    else if (!hibernate_resume(setup_ui)) // the UI saved when closed, else:
+    {
+        setup_ui(HIBERNATE_UI_GUI);
+        //setup_ui(HIBERNATE_UI_WATCH);
     }
-    else
-        my_watch();
 
     //lv_demo_widgets();
     //lv_demo_benchmark();
     //lv_demo_keypad_encoder();
     //lv_demo_printer();
     //lv_demo_stress();
+    //font_cache_bench();
+    //tlsf_mem_bench();
     //lv_ex_get_started_1();
     //lv_ex_get_started_2();
     //lv_ex_get_started_3();
@@ -192,6 +247,28 @@ int main(int argc, char** argv)
 *   STATIC FUNCTIONS
 **********************/
 
+/**
+* Set up one of the watch UIs on the active screen
+* @param ui HIBERNATE_UI_GUI or HIBERNATE_UI_WATCH
+*/
+static void setup_ui(uint8_t ui)
+{
+    if (ui == HIBERNATE_UI_GUI)
+    {
+        setupGui();
+        updateBatteryLevel();
+        updateStepCounter(123);
+        update_time(true);
+        lv_task_create(wifi_scan_task, 200, LV_TASK_PRIO_LOW, NULL);
+
+        lv_disp_trig_activity(NULL);
+    }
+    else
+        my_watch();
+
+    hibernate_init(ui);
+}
+
 /**
 * A task to measure the elapsed time for LittlevGL
 * @param data unused
@@ -213,6 +290,29 @@ static Uint32 my_tick_timer(Uint32 interval, void *param)
     return 5; // next call
 }
 
+/**
+* Called by LittlevGL at the end of each refresh
+* @param disp_drv the display driver
+* @param time duration of the refresh [ms]
+* @param px number of refreshed pixels
+*/
+static void monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px)
+{
+    if (boot_us)
+    {
+        lv_mem_monitor_t mon;
+        mem_monitor(&mon);
+        MY_LOG("First frame %d ms after boot, heap %d bytes used", (get_time_us() - boot_us) / 1000, mon.total_size - mon.free_size);
+        boot_us = 0;
+    }
+
+#if MONITOR_PARTIAL_UPLOAD
+    sdl_monitor_present(); // once for all flushed areas
+#endif
+    overdraw_frame_done();
+    draw_cache_frame_done();
+}
+
 /**
 * Initialize the Hardware Abstraction Layer (HAL) for the Littlev graphics library
 */
@@ -220,7 +320,11 @@ static void hal_init(void)
 {
     /* Add a display
     * Use the 'monitor' driver which creates window on PC's monitor to simulate a display*/
+#if MONITOR_PARTIAL_UPLOAD
+    sdl_monitor_init();
+#else
     monitor_init();
+#endif
 
     static lv_disp_buf_t disp_buf1;
     static lv_color_t buf1_1[LV_HOR_RES_MAX * 120];
@@ -229,8 +333,15 @@ static void hal_init(void)
     lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);            /*Basic initialization*/
     disp_drv.buffer = &disp_buf1;
+#if MONITOR_PARTIAL_UPLOAD
+    disp_drv.flush_cb = sdl_monitor_flush;
+#else
     disp_drv.flush_cb = monitor_flush;
-    lv_disp_drv_register(&disp_drv);
+#endif
+    disp_drv.monitor_cb = monitor_cb;
+    lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+    area_merge_init(disp);
+    layer_cache_init(disp);
 
     /* Add the mouse (or touchpad) as input device
     * Use the 'mouse' driver which reads the PC's mouse*/
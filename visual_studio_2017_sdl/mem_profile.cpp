@@ -0,0 +1,284 @@
+// ------------------------------------------------------------------------
+// Heap profile: lv_mem allocations by call site and owner (app or tile)
+// ------------------------------------------------------------------------
+//
+// LVGL allocates deep inside its API, so the call site is not passed down.
+// Instead the app code marks scopes: MEM_PROFILE_SCOPE(owner, site) pushes
+// a tag, and every allocation while it is innermost is counted for it.
+// E.g. App::create() uses the app's name and "App::create", so a report
+// lists how much each app keeps, and WatchApp::updateBattery() lists the
+// label texts it reallocates every time.
+//
+// The live blocks are kept in a hash table (linear probing) from address
+// to tag and size, so frees are counted for the tag which allocated them.
+// All of it is compiled out with USE_MEM_PROFILE 0.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "mem_profile.h"
+
+#if USE_MEM_PROFILE
+
+#define NO_TAG 0xFF
+
+typedef struct
+{
+    const char *owner;    // NULL: none
+    const char *site;
+    uint32_t live_bytes;
+    uint32_t live_blocks;
+    uint32_t peak_bytes;
+    uint32_t allocs;      // incl. reallocs, since reset
+    uint32_t alloc_bytes;
+} tag_t;
+
+typedef struct
+{
+    void *ptr;            // NULL: empty
+    uint32_t size;
+    uint8_t tag;
+} entry_t;
+
+static tag_t tags[MEM_PROFILE_MAX_TAGS];
+static uint8_t num_tags;
+
+static entry_t blocks[MEM_PROFILE_MAX_BLOCKS];
+static uint32_t num_blocks;
+static uint32_t untracked; // table full
+
+static const char *owners[MEM_PROFILE_MAX_DEPTH];
+static const char *sites[MEM_PROFILE_MAX_DEPTH];
+static uint8_t depth;
+static uint8_t current = NO_TAG; // of the innermost scope, NO_TAG: not looked up yet
+
+static uint32_t reset_tick;
+
+// ------------------------------------------------------------------------
+// Tags
+// ------------------------------------------------------------------------
+
+static uint8_t find_tag(const char *owner, const char *site)
+{
+    for (uint8_t i = 0; i < num_tags; i++)
+    {
+        if ((tags[i].owner == owner) && (tags[i].site == site))
+            return i;
+    }
+
+    if (num_tags >= MEM_PROFILE_MAX_TAGS - 1) // the last one for the rest
+    {
+        tags[MEM_PROFILE_MAX_TAGS - 1].site = "(other)";
+        return MEM_PROFILE_MAX_TAGS - 1;
+    }
+
+    tag_t *t = &tags[num_tags];
+    t->owner = owner;
+    t->site  = site;
+    return num_tags++;
+}
+
+static uint8_t get_current(void)
+{
+    if (current == NO_TAG)
+    {
+        uint8_t top = LV_MATH_MIN(depth, MEM_PROFILE_MAX_DEPTH);
+        current = top ? find_tag(owners[top - 1], sites[top - 1]) : find_tag(NULL, NULL);
+    }
+    return current;
+}
+
+// ------------------------------------------------------------------------
+// Live blocks
+// ------------------------------------------------------------------------
+
+static uint32_t hash(const void *ptr)
+{
+    uint32_t x = (uint32_t)((uintptr_t)ptr >> 3); // aligned
+    x ^= x >> 16;
+    x *= 0x45d9f3bU;
+    x ^= x >> 16;
+    return x & (MEM_PROFILE_MAX_BLOCKS - 1);
+}
+
+static entry_t *find_block(const void *ptr)
+{
+    for (uint32_t i = hash(ptr); blocks[i].ptr; i = (i + 1) & (MEM_PROFILE_MAX_BLOCKS - 1))
+    {
+        if (blocks[i].ptr == ptr)
+            return &blocks[i];
+    }
+    return NULL;
+}
+
+static void add_block(void *ptr, size_t size, uint8_t tag)
+{
+    tag_t *t = &tags[tag];
+    t->allocs++;
+    t->alloc_bytes += (uint32_t)size;
+
+    if (num_blocks >= MEM_PROFILE_MAX_BLOCKS * 3 / 4) // keep the probes short
+    {
+        untracked++;
+        return;
+    }
+
+    uint32_t i = hash(ptr);
+    while (blocks[i].ptr)
+        i = (i + 1) & (MEM_PROFILE_MAX_BLOCKS - 1);
+    blocks[i].ptr  = ptr;
+    blocks[i].size = (uint32_t)size;
+    blocks[i].tag  = tag;
+    num_blocks++;
+
+    t->live_bytes += (uint32_t)size;
+    t->live_blocks++;
+    if (t->live_bytes > t->peak_bytes)
+        t->peak_bytes = t->live_bytes;
+}
+
+static void remove_block(entry_t *e)
+{
+    tag_t *t = &tags[e->tag];
+    t->live_bytes -= e->size;
+    t->live_blocks--;
+    num_blocks--;
+
+    // shift the following entries back into the gap unless they are at home
+    uint32_t mask = MEM_PROFILE_MAX_BLOCKS - 1;
+    uint32_t i = (uint32_t)(e - blocks);
+    for (uint32_t j = (i + 1) & mask; blocks[j].ptr; j = (j + 1) & mask)
+    {
+        uint32_t k = hash(blocks[j].ptr);
+        bool home = (i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j));
+        if (home)
+            continue;
+        blocks[i] = blocks[j];
+        i = j;
+    }
+    blocks[i].ptr = NULL;
+}
+
+// ------------------------------------------------------------------------
+// Report
+// ------------------------------------------------------------------------
+
+#if MEM_PROFILE_REPORT_PERIOD
+static void report_task_cb(lv_task_t *task)
+{
+    mem_profile_report();
+}
+#endif
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+void mem_profile_push(const char *owner, const char *site)
+{
+    if (depth < MEM_PROFILE_MAX_DEPTH)
+    {
+        owners[depth] = owner ? owner : (depth ? owners[depth - 1] : NULL);
+        sites[depth]  = site  ? site  : (depth ? sites[depth - 1]  : NULL);
+    }
+    else if (depth == MEM_PROFILE_MAX_DEPTH)
+        MY_LOG("Heap profile: scopes nested too deep");
+    depth++;
+    current = NO_TAG;
+}
+
+void mem_profile_pop(void)
+{
+    if (!depth)
+        return;
+
+    depth--;
+    current = NO_TAG;
+}
+
+void mem_profile_alloc(void *ptr, size_t size)
+{
+    if (ptr)
+        add_block(ptr, size, get_current());
+}
+
+void mem_profile_free(void *ptr)
+{
+    entry_t *e = ptr ? find_block(ptr) : NULL;
+    if (e)
+        remove_block(e);
+}
+
+void mem_profile_realloc(void *old_ptr, void *ptr, size_t size)
+{
+    if (!ptr && size)
+        return; // failed, the old block stays
+
+    mem_profile_free(old_ptr);
+    mem_profile_alloc(ptr, size);
+}
+
+void mem_profile_init(void)
+{
+#if MEM_PROFILE_REPORT_PERIOD
+    static lv_task_t *report_task = NULL;
+    if (!report_task)
+        report_task = lv_task_create(report_task_cb, MEM_PROFILE_REPORT_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+#endif
+    reset_tick = lv_tick_get();
+}
+
+void mem_profile_report(void)
+{
+    uint8_t order[MEM_PROFILE_MAX_TAGS];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < MEM_PROFILE_MAX_TAGS; i++)
+    {
+        if (tags[i].allocs || tags[i].live_blocks)
+            order[n++] = i;
+    }
+
+    // by live bytes, then by allocations
+    for (uint8_t i = 1; i < n; i++)
+    {
+        uint8_t tag = order[i];
+        uint8_t j = i;
+        while (j && ((tags[order[j - 1]].live_bytes < tags[tag].live_bytes) ||
+                     ((tags[order[j - 1]].live_bytes == tags[tag].live_bytes) && (tags[order[j - 1]].allocs < tags[tag].allocs))))
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = tag;
+    }
+
+    uint32_t elapsed = LV_MATH_MAX(lv_tick_elaps(reset_tick), 1);
+    uint32_t live = 0;
+    MY_LOG("Heap profile over %d s: live bytes (blocks, peak), allocations/s, bytes/s", elapsed / 1000);
+    for (uint8_t i = 0; i < n; i++)
+    {
+        tag_t *t = &tags[order[i]];
+        live += t->live_bytes;
+        MY_LOG("  %-16s %-32s %6d (%4d, %6d) %6d.%d %8d",
+            t->owner ? t->owner : "-", t->site ? t->site : "-",
+            t->live_bytes, t->live_blocks, t->peak_bytes,
+            (uint32_t)((uint64_t)t->allocs * 1000 / elapsed), (uint32_t)((uint64_t)t->allocs * 10000 / elapsed % 10),
+            (uint32_t)((uint64_t)t->alloc_bytes * 1000 / elapsed));
+    }
+    MY_LOG("  %d bytes in %d blocks tracked, %d allocations untracked (table full)", live, num_blocks, untracked);
+}
+
+void mem_profile_reset(void)
+{
+    for (uint8_t i = 0; i < MEM_PROFILE_MAX_TAGS; i++)
+    {
+        tags[i].allocs = 0;
+        tags[i].alloc_bytes = 0;
+        tags[i].peak_bytes = tags[i].live_bytes;
+    }
+    untracked = 0;
+    reset_tick = lv_tick_get();
+}
+
+#endif // USE_MEM_PROFILE
+
+// ------------------------------------------------------------------------
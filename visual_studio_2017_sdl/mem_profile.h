@@ -0,0 +1,74 @@
+// ------------------------------------------------------------------------
+// Heap profile: lv_mem allocations by call site and owner (app or tile)
+// ------------------------------------------------------------------------
+
+#ifndef __MEM_PROFILE_H__
+#define __MEM_PROFILE_H__
+
+// 1: tag every allocation of lv_mem_alloc() with the innermost scope
+//    (needs LV_MEM_TLSF, the allocator is hooked in tlsf_mem)
+#ifndef USE_MEM_PROFILE
+#define USE_MEM_PROFILE 0
+#endif
+#if USE_MEM_PROFILE && !LV_MEM_TLSF
+#undef USE_MEM_PROFILE
+#define USE_MEM_PROFILE 0
+#endif
+
+#define MEM_PROFILE_MAX_TAGS      64   // owner and site pairs, the last one collects the rest
+#define MEM_PROFILE_MAX_BLOCKS    4096 // live blocks tracked, power of 2
+#define MEM_PROFILE_MAX_DEPTH     8    // nested scopes
+#define MEM_PROFILE_REPORT_PERIOD 0    // ms, 0: no periodic report
+
+#if USE_MEM_PROFILE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Until the matching pop, allocations are counted for owner and site
+// (static strings). NULL: the one of the outer scope.
+void mem_profile_push(const char *owner, const char *site);
+void mem_profile_pop(void);
+
+// used by tlsf_mem
+void mem_profile_alloc(void *ptr, size_t size);
+void mem_profile_free(void *ptr);
+void mem_profile_realloc(void *old_ptr, void *ptr, size_t size);
+
+// start the periodic report (if MEM_PROFILE_REPORT_PERIOD)
+void mem_profile_init(void);
+
+// log the tags sorted by live bytes, with the allocations per second
+void mem_profile_report(void);
+void mem_profile_reset(void); // rates only, live blocks stay tracked
+
+#ifdef __cplusplus
+} // extern "C"
+
+class MemProfileScope
+{
+public:
+    MemProfileScope(const char *owner, const char *site) { mem_profile_push(owner, site); }
+    ~MemProfileScope() { mem_profile_pop(); }
+};
+
+// e.g. MEM_PROFILE_SCOPE(name, __FUNCTION__);
+#define MEM_PROFILE_SCOPE(owner, site) MemProfileScope mem_profile_scope(owner, site)
+
+#endif // __cplusplus
+
+#else // compiled out
+
+#define mem_profile_push(owner, site)
+#define mem_profile_pop()
+#define mem_profile_init()
+#define mem_profile_report()
+#define mem_profile_reset()
+#define MEM_PROFILE_SCOPE(owner, site)
+
+#endif // USE_MEM_PROFILE
+
+#endif // __MEM_PROFILE_H__
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,144 @@
+// ------------------------------------------------------------------------
+// Memory telemetry: history of the lv_mem heap, sampled every second
+// ------------------------------------------------------------------------
+//
+// A sample is one walk of the heap by mem_monitor() (a few hundred blocks
+// in 64 KB), run by a task of the lowest priority, i.e. after the refresh.
+// The history is a ring buffer of MEM_TELEMETRY_HISTORY compact samples.
+// The time of each sample is measured, so its cost shows in the report
+// instead of the frame times.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "tlsf_mem.h"
+#include "mem_telemetry.h"
+
+static mem_sample_t history[MEM_TELEMETRY_HISTORY];
+static uint16_t next; // index of the next sample
+static uint16_t count;
+
+static uint32_t high_water;
+static uint32_t min_biggest = UINT32_MAX;
+static uint32_t total_size;
+
+static uint32_t sample_us, sample_us_max;
+
+// ------------------------------------------------------------------------
+// Task
+// ------------------------------------------------------------------------
+
+#if USE_MEM_TELEMETRY
+static void sample_task_cb(lv_task_t *task)
+{
+    mem_telemetry_sample();
+}
+#endif
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+void mem_telemetry_init(void)
+{
+#if USE_MEM_TELEMETRY
+    static lv_task_t *sample_task = NULL;
+    if (!sample_task)
+        sample_task = lv_task_create(sample_task_cb, MEM_TELEMETRY_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+#endif
+    mem_telemetry_sample();
+}
+
+const mem_sample_t *mem_telemetry_sample(void)
+{
+    uint32_t start = get_time_us();
+
+    lv_mem_monitor_t mon;
+    mem_monitor(&mon);
+
+    mem_sample_t *s = &history[next];
+    s->time         = lv_tick_get();
+    s->free_size    = mon.free_size;
+    s->free_biggest = mon.free_biggest_size;
+    s->frag_pct     = mon.frag_pct;
+    s->used_pct     = mon.used_pct;
+
+    next = (next + 1) % MEM_TELEMETRY_HISTORY;
+    if (count < MEM_TELEMETRY_HISTORY)
+        count++;
+
+    total_size = mon.total_size;
+    uint32_t used = mon.total_size - mon.free_size;
+#if LV_MEM_TLSF
+    used = LV_MATH_MAX(used, tlsf_mem_get_max_used()); // payload, between samples
+#endif
+    if (used > high_water)
+        high_water = used;
+    if (mon.free_biggest_size < min_biggest)
+        min_biggest = mon.free_biggest_size;
+
+    sample_us = get_time_us() - start;
+    if (sample_us > sample_us_max)
+        sample_us_max = sample_us;
+    return s;
+}
+
+bool mem_telemetry_get(uint16_t age, mem_sample_t *sample)
+{
+    if (age >= count)
+        return false;
+
+    uint16_t i = (next + MEM_TELEMETRY_HISTORY - 1 - age) % MEM_TELEMETRY_HISTORY;
+    if (sample)
+        *sample = history[i];
+    return true;
+}
+
+uint16_t mem_telemetry_get_count(void)
+{
+    return count;
+}
+
+uint32_t mem_telemetry_get_high_water(void)
+{
+    return high_water;
+}
+
+uint32_t mem_telemetry_get_min_biggest(void)
+{
+    return count ? min_biggest : 0;
+}
+
+uint32_t mem_telemetry_get_sample_time(void)
+{
+    return sample_us;
+}
+
+uint32_t mem_telemetry_get_sample_time_max(void)
+{
+    return sample_us_max;
+}
+
+void mem_telemetry_report(void)
+{
+    mem_sample_t s;
+    if (!mem_telemetry_get(0, &s))
+    {
+        MY_LOG("Memory telemetry: no samples");
+        return;
+    }
+
+    // trend over the history
+    mem_sample_t oldest;
+    mem_telemetry_get(count - 1, &oldest);
+
+    MY_LOG("Memory telemetry: %d of %d bytes free, biggest %d, fragmentation %d%%, used %d%%",
+        s.free_size, total_size, s.free_biggest, s.frag_pct, s.used_pct);
+    MY_LOG("  high water %d bytes, smallest biggest block %d bytes",
+        high_water, min_biggest);
+    MY_LOG("  %d samples over %d s: free %+d bytes, biggest %+d bytes",
+        count, (s.time - oldest.time) / 1000,
+        (int32_t)(s.free_size - oldest.free_size), (int32_t)(s.free_biggest - oldest.free_biggest));
+    MY_LOG("  sample takes %d us (max %d us)", sample_us, sample_us_max);
+}
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,56 @@
+// ------------------------------------------------------------------------
+// Memory telemetry: history of the lv_mem heap, sampled every second
+// ------------------------------------------------------------------------
+
+#ifndef __MEM_TELEMETRY_H__
+#define __MEM_TELEMETRY_H__
+
+// 1: sample the heap by a low priority task, else only on request
+#ifndef USE_MEM_TELEMETRY
+#define USE_MEM_TELEMETRY 1
+#endif
+
+#define MEM_TELEMETRY_PERIOD  1000 // ms
+#define MEM_TELEMETRY_HISTORY 60   // samples in the ring buffer
+
+typedef struct
+{
+    uint32_t time;         // lv_tick_get() of the sample
+    uint32_t free_size;    // bytes
+    uint32_t free_biggest; // bytes, largest block to allocate
+    uint8_t frag_pct;
+    uint8_t used_pct;
+} mem_sample_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// start the sampling task (if USE_MEM_TELEMETRY), takes a first sample
+void mem_telemetry_init(void);
+
+// take a sample now, e.g. in a benchmark, and add it to the history
+const mem_sample_t *mem_telemetry_sample(void);
+
+// age 0: latest sample, false if there is none that old
+bool mem_telemetry_get(uint16_t age, mem_sample_t *sample);
+uint16_t mem_telemetry_get_count(void); // samples in the history
+
+// all-time extremes of the samples; the high-water mark also covers the
+// time between them if the heap tracks it (LV_MEM_TLSF)
+uint32_t mem_telemetry_get_high_water(void);  // bytes used at most
+uint32_t mem_telemetry_get_min_biggest(void); // smallest largest free block
+
+// time of a sample (walks the heap), us
+uint32_t mem_telemetry_get_sample_time(void);
+uint32_t mem_telemetry_get_sample_time_max(void);
+
+void mem_telemetry_report(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __MEM_TELEMETRY_H__
+
+// ------------------------------------------------------------------------
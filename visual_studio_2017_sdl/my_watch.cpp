@@ -4,6 +4,20 @@
 
 #include "my_watch.h"
 #include "lvgl/lvgl.h"
+#include "overdraw.h"
+#include "area_merge.h"
+#include "ui_txn.h"
+#include "num_label.h"
+#include "num_roller.h"
+#include "vlist.h"
+#include "layer_cache.h"
+#include "app_arena.h"
+#include "mem_profile.h"
+#include "draw_cache.h"
+#include "font_cache.h"
+#include "label_fast.h"
+#include "label_text.h"
+#include "style_pool.h"
 #include "math.h"
 
 // display size
@@ -44,26 +58,15 @@ static const char * weekday_names[7] = {
 	"Sonntag", "Montag", "Dienstag", "Mittwoch", "Donnerstag", "Freitag", "Samstag" 
 };
 
-static const char * options_0_23 =
-	"0\n1\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\n12\n13\n14\n15\n16\n17\n18\n19\n20\n21\n22\n23";
-
-static const char * options_0_59 =
-	"0\n1\n2\n3\n4\n5\n6\n7\n8\n9\n"
-	"10\n11\n12\n13\n14\n15\n16\n17\n18\n19\n"
-	"20\n21\n22\n23\n24\n25\n26\n27\n28\n29\n"
-	"30\n31\n32\n33\n34\n35\n36\n37\n38\n39\n"
-	"40\n41\n42\n43\n44\n45\n46\n47\n48\n49\n"
-	"50\n51\n52\n53\n54\n55\n56\n57\n58\n59";
-
 enum {
 	HOUR_NONE = 100,
 	MIN_NONE  = 100,
 	SEC_NONE  = 100
 };
 
-#define MAX_TILES 10
+// the tileview creates the widgets of the active tile and its neighbours only
+#define TILE_WINDOW 1 // neighbours on each side
 static lv_coord_t num_tiles;
-static lv_point_t tile_pos[MAX_TILES];
 
 static lv_obj_t * home;
 static lv_obj_t * app;
@@ -91,66 +94,87 @@ inline uint32_t diff_time(uint32_t curr_ms, uint32_t start_ms)
 // List Demo
 // ------------------------------------------------------------------------
 
-static void list_btn_cb(lv_obj_t * obj, lv_event_t event)
+typedef struct
+{
+	const char *symbol;
+	const char *text;
+} list_item_t;
+
+static const list_item_t list_items[] = {
+	{ LV_SYMBOL_SETTINGS,     "Zeit" },
+	{ LV_SYMBOL_BELL,         "Wecker" },
+	{ LV_SYMBOL_AUDIO,        "Ton" },
+	{ LV_SYMBOL_IMAGE,        "Anzeige" },
+	{ LV_SYMBOL_WIFI,         "WLAN" },
+	{ LV_SYMBOL_BLUETOOTH,    "Bluetooth" },
+	{ LV_SYMBOL_BATTERY_FULL, "Batterie" },
+	{ LV_SYMBOL_SD_CARD,      "Speicherkarte" },
+	{ LV_SYMBOL_CALL,         "Telefon" },
+	{ LV_SYMBOL_GPS,          "GPS" },
+};
+
+static void list_row_cb(lv_obj_t * list, uint16_t index, vlist_row_t * row)
+{
+	row->symbol = list_items[index].symbol;
+	strncpy(row->text, list_items[index].text, VLIST_TEXT_LEN);
+}
+
+static void demo_list(lv_obj_t *parent);
+
+static void open_demo_app(void)
 {
-	if (event == LV_EVENT_CLICKED) {
-		MY_LOG("List button %s clicked", lv_list_get_btn_text(obj));
+	if (app) {
+		MY_LOG("Switching to existing app");
+	}
+	else {
+		MY_LOG("Creating new app");
+		MEM_PROFILE_SCOPE("Demo", __FUNCTION__);
+		app = app_arena_create_screen(APP_ARENA_SIZE);
+		app_arena_begin(app);
+		demo_list(app);
+		app_arena_end();
+	}
+	lv_scr_load(app);
+}
+
+// return true if the app was deleted
+static bool close_demo_app(void)
+{
+	MY_LOG("Switching back to home screen");
+	lv_scr_load(home);
+
+	if (!app)
+		return false;
+
+	MY_LOG("Killing app");
+	lv_obj_del(app);
+	app = NULL;
+	return true;
+}
 
-		MY_LOG("Switching back to home screen");
-		lv_scr_load(home);
+static void list_cb(lv_obj_t * obj, lv_event_t event)
+{
+	if (event == LV_EVENT_VALUE_CHANGED) {
+		uint32_t index = *(uint32_t *)lv_event_get_data();
+		MY_LOG("List button %s clicked", list_items[index].text);
 
-		if (app) {
-			MY_LOG("Killing app");
-			lv_obj_del(app);
-			app = NULL;
+		if (close_demo_app()) {
+			app_arena_report();
+			mem_profile_report();
 		}
 	}
 }
 
 static void demo_list(lv_obj_t *parent)
 {
-	// Create a list
-	lv_obj_t *list = lv_list_create(parent, NULL);
+	// Create a list, rows are filled by list_row_cb
+	lv_obj_t *list = vlist_create(parent, list_row_cb);
 	lv_obj_set_size(list, WIDTH-20, HEIGHT-20);
-	//lv_obj_set_size(list, lv_obj_get_width(parent), lv_obj_get_height(parent));
-	//lv_page_set_scrollable_fit2(list, LV_FIT_PARENT, LV_FIT_PARENT);
-//	lv_cont_set_fit2(list, LV_FIT_PARENT, LV_FIT_PARENT);
 	MY_LOG("Demo list %dx%d", lv_obj_get_width(list), lv_obj_get_height(list));
 	lv_obj_align(list, NULL, LV_ALIGN_CENTER, 0, 0);
-	//lv_list_set_edge_flash(list, true);
-
-	// Add buttons to the list
-	lv_obj_t *btn;
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_SETTINGS, "Zeit");
-	lv_obj_set_event_cb(btn, list_btn_cb);
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_BELL, "Wecker");
-	lv_obj_set_event_cb(btn, list_btn_cb);
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_AUDIO, "Ton");
-	lv_obj_set_event_cb(btn, list_btn_cb);
+	lv_obj_set_event_cb(list, list_cb);
 
-	btn = lv_list_add_btn(list, LV_SYMBOL_IMAGE, "Anzeige");
-	lv_obj_set_event_cb(btn, list_btn_cb);
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_WIFI, "WLAN");
-	lv_obj_set_event_cb(btn, list_btn_cb);
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_BLUETOOTH, "Bluetooth");
-	lv_obj_set_event_cb(btn, list_btn_cb);
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_BATTERY_FULL, "Batterie");
-	lv_obj_set_event_cb(btn, list_btn_cb);
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_SD_CARD, "Speicherkarte");
-	lv_obj_set_event_cb(btn, list_btn_cb);
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_CALL, "Telefon");
-	lv_obj_set_event_cb(btn, list_btn_cb);
-
-	btn = lv_list_add_btn(list, LV_SYMBOL_GPS, "GPS");
-	lv_obj_set_event_cb(btn, list_btn_cb);
+	vlist_set_count(list, sizeof(list_items) / sizeof(list_items[0]));
 }
 
 // ------------------------------------------------------------------------
@@ -162,11 +186,12 @@ class BaseTile
 public:
 	//BaseTile() : tile(NULL), name("???") {}
 
+	// add the tile to the tileview, the widgets are created by materialize()
 	void create(lv_obj_t * parent, const char *name)
 	{
 		this->name = name;
 
-		if (num_tiles >= MAX_TILES) {
+		if (num_tiles >= LV_COORD_MAX / WIDTH) { // tile positions
 			MY_LOG("No more tiles available");
 			return;
 		}
@@ -174,32 +199,75 @@ public:
 		if (! num_tiles) // init
 		{
 			lv_style_init(&style_time);
-			lv_style_set_text_font(&style_time, LV_STATE_DEFAULT, &lv_font_montserrat_48);
+			lv_style_set_text_font(&style_time, LV_STATE_DEFAULT, font_cache_wrap(&lv_font_montserrat_48));
 		}
 
+		tv = parent;
+		pos = num_tiles++;
+
+		next = NULL;
+		if (last)
+			last->next = this;
+		else
+			first = this;
+		last = this;
+	}
+
+	// create the widgets from the state of the tile
+	void materialize()
+	{
+		if (tile)
+			return;
+
+		MEM_PROFILE_SCOPE(name, __FUNCTION__);
+		lv_obj_t * parent = tv;
 #if 1
 		// container
 		tile = lv_cont_create(parent, NULL);
 		//lv_obj_reset_style_list(cont, LV_CONT_PART_MAIN); // remove border
-		lv_obj_set_style_local_border_side(tile, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+		style_pool_add_int(tile, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
 		lv_obj_set_size(tile, WIDTH, HEIGHT);
 		lv_cont_set_layout(tile, LV_LAYOUT_CENTER);
 		//lv_obj_set_drag_parent(tile, true);
 #else
 		tile = lv_obj_create(parent, NULL);
-		lv_obj_set_style_local_border_side(tile, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+		style_pool_add_int(tile, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
 		lv_obj_set_size(tile, WIDTH-20, HEIGHT-20);
 #endif
-		lv_obj_set_pos(tile, num_tiles*WIDTH, 0);
+		lv_obj_set_pos(tile, pos*WIDTH, 0);
 		lv_tileview_add_element(parent, tile);
 
 		populate();
+	}
 
-		tile_pos[num_tiles].x = num_tiles;
-		tile_pos[num_tiles].y = 0;
-		num_tiles++;
+	// delete the widgets, the state of the tile is kept
+	void depopulate()
+	{
+		if (!tile)
+			return;
+
+		lv_obj_del(tile);
+		tile = NULL;
+		rol_hour = rol_min = rol_sec = NULL;
+		arc = btn = NULL;
+		forget();
 	}
 
+	// widgets deleted: clear the pointers to them
+	virtual void forget() {}
+
+	// hibernate: copy the state of the tile, restore() while depopulated
+	virtual void save(my_watch_state_t *state) {}
+	virtual void restore(const my_watch_state_t *state) {}
+
+	inline lv_coord_t get_pos() { return pos; }
+	inline bool is_created() { return tile != NULL; }
+	inline bool is_visible() { return tile && lv_obj_is_visible(tile); }
+
+	// tiles in the order of creation
+	static inline BaseTile * get_first() { return first; }
+	inline BaseTile * get_next() { return next; }
+
 	virtual void populate()
 	{
 		// dummy implementation
@@ -283,15 +351,7 @@ public:
 	virtual void button_clicked_cb() 
 	{
 		// dummy implementation
-		if (app) {
-			MY_LOG("Switching to existing app");
-		}
-		else {
-			MY_LOG("Creating new app");
-			app = lv_obj_create(NULL, NULL);
-			demo_list(app);
-		}
-		lv_scr_load(app);
+		open_demo_app();
 	}
 
 	// --------------------------------------------------------------------
@@ -300,9 +360,11 @@ public:
 
 	void populate_hour_min_sec(uint16_t hour, uint16_t min, uint16_t sec)
 	{
+		MEM_PROFILE_SCOPE(name, __FUNCTION__);
+
 		// container
 		lv_obj_t * cont = lv_cont_create(get_parent(), NULL);
-		lv_obj_set_style_local_border_side(cont, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+		style_pool_add_int(cont, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
 		lv_cont_set_layout(cont, LV_LAYOUT_ROW_MID);
 		lv_cont_set_fit(cont, LV_FIT_TIGHT);
 		lv_page_glue_obj(cont, true);
@@ -311,10 +373,10 @@ public:
 		if (hour != HOUR_NONE)
 		{
 			// roller
-			lv_obj_t * rol = lv_roller_create(cont, NULL);
-			lv_roller_set_options(rol, options_0_23, LV_ROLLER_MODE_NORMAL);
-			lv_roller_set_visible_row_count(rol, 3);
-			lv_roller_set_selected(rol, hour, LV_ANIM_OFF);
+			lv_obj_t * rol = num_roller_create(cont);
+			num_roller_set_range(rol, 0, 23, "%d");
+			num_roller_set_visible_row_count(rol, 3);
+			num_roller_set_value(rol, hour, LV_ANIM_OFF);
 			lv_obj_set_user_data(rol, this);
 			lv_obj_set_event_cb(rol, rol_hour_cb);
 			//lv_page_glue_obj(rol, true);
@@ -332,10 +394,10 @@ public:
 			}
 
 			// roller
-			lv_obj_t * rol = lv_roller_create(cont, NULL);
-			lv_roller_set_options(rol, options_0_59, LV_ROLLER_MODE_NORMAL);
-			lv_roller_set_visible_row_count(rol, 3);
-			lv_roller_set_selected(rol, min, LV_ANIM_OFF);
+			lv_obj_t * rol = num_roller_create(cont);
+			num_roller_set_range(rol, 0, 59, "%d");
+			num_roller_set_visible_row_count(rol, 3);
+			num_roller_set_value(rol, min, LV_ANIM_OFF);
 			lv_obj_set_user_data(rol, this);
 			lv_obj_set_event_cb(rol, rol_min_cb);
 			//lv_page_glue_obj(rol, true);
@@ -353,11 +415,10 @@ public:
 			}
 
 			// roller
-			lv_obj_t * rol = lv_roller_create(cont, NULL);
-//			lv_roller_set_options(rol, options_0_59, LV_ROLLER_MODE_INIFINITE); // shows strange animation
-			lv_roller_set_options(rol, options_0_59, LV_ROLLER_MODE_NORMAL);
-			lv_roller_set_visible_row_count(rol, 3);
-			lv_roller_set_selected(rol, sec, LV_ANIM_OFF);
+			lv_obj_t * rol = num_roller_create(cont);
+			num_roller_set_range(rol, 0, 59, "%d");
+			num_roller_set_visible_row_count(rol, 3);
+			num_roller_set_value(rol, sec, LV_ANIM_OFF);
 			lv_obj_set_user_data(rol, this);
 			lv_obj_set_event_cb(rol, rol_sec_cb);
 			//lv_page_glue_obj(rol, true);
@@ -374,26 +435,26 @@ public:
 	void set_hour(uint16_t hour)
 	{
 		if (rol_hour)
-			lv_roller_set_selected(rol_hour, hour, LV_ANIM_ON);
+			num_roller_set_value(rol_hour, hour, LV_ANIM_ON);
 	}
 
 	void set_min(uint16_t min)
 	{
 		if (rol_min)
-			lv_roller_set_selected(rol_min, min, LV_ANIM_ON);
+			num_roller_set_value(rol_min, min, LV_ANIM_ON);
 	}
 
 	void set_sec(uint16_t sec)
 	{
 		if (rol_sec)
-			lv_roller_set_selected(rol_sec, sec, LV_ANIM_ON);
+			num_roller_set_value(rol_sec, sec, LV_ANIM_ON);
 	}
 
 	static void rol_hour_cb(lv_obj_t * obj, lv_event_t event)
 	{
 		if (event == LV_EVENT_VALUE_CHANGED)
 		{
-			uint16_t pos = lv_roller_get_selected(obj);
+			uint16_t pos = num_roller_get_value(obj);
 			MY_LOG("Selected hour %d", pos);
 			BaseTile *inst = (BaseTile *)lv_obj_get_user_data(obj);
 			if (inst)
@@ -405,7 +466,7 @@ public:
 	{
 		if (event == LV_EVENT_VALUE_CHANGED)
 		{
-			uint16_t pos = lv_roller_get_selected(obj);
+			uint16_t pos = num_roller_get_value(obj);
 			MY_LOG("Selected min %d", pos);
 			BaseTile *inst = (BaseTile *)lv_obj_get_user_data(obj);
 			if (inst)
@@ -417,7 +478,7 @@ public:
 	{
 		if (event == LV_EVENT_VALUE_CHANGED)
 		{
-			uint16_t pos = lv_roller_get_selected(obj);
+			uint16_t pos = num_roller_get_value(obj);
 			MY_LOG("Selected sec %d", pos);
 			BaseTile *inst = (BaseTile *)lv_obj_get_user_data(obj);
 			if (inst)
@@ -437,7 +498,7 @@ public:
 	{
 		// container
 		lv_obj_t * cont = lv_cont_create(get_parent(), NULL);
-		lv_obj_set_style_local_border_side(cont, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+		style_pool_add_int(cont, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
 		lv_cont_set_layout(cont, LV_LAYOUT_ROW_MID);
 		lv_cont_set_fit(cont, LV_FIT_TIGHT);
 		lv_page_glue_obj(cont, true);
@@ -475,7 +536,7 @@ public:
 	void populate_arc()
 	{
 		arc = lv_arc_create(get_parent(), NULL);
-		lv_obj_set_style_local_border_side(arc, LV_CALENDAR_PART_BG, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+		style_pool_add_int(arc, LV_CALENDAR_PART_BG, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
 		lv_obj_set_size(arc, WIDTH * 2 / 3, HEIGHT * 2 / 3);
 //		lv_obj_set_size(arc, WIDTH-40, HEIGHT-40);
 		//lv_arc_set_rotation(arc, -90); // makes 0� at 12 o'clock, but does not work
@@ -555,6 +616,11 @@ protected:
 	static lv_style_t style_time;
 
 private:
+	static BaseTile *first, *last;
+	BaseTile *next;
+	lv_obj_t *tv;
+	lv_coord_t pos;
+
 	// GUI
 	lv_obj_t *tile;
 	lv_obj_t *rol_hour, *rol_min, *rol_sec;
@@ -563,6 +629,8 @@ private:
 };
 
 lv_style_t BaseTile::style_time;
+BaseTile *BaseTile::first;
+BaseTile *BaseTile::last;
 
 
 // ------------------------------------------------------------------------
@@ -578,32 +646,44 @@ public:
 		//lv_style_set_color(&style1, LV_STATE_DISABLED, LV_COLOR_GRAY);
 
 		cal = lv_calendar_create(get_parent(), NULL);
-		lv_obj_set_style_local_border_side(cal, LV_CALENDAR_PART_BG, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
-		lv_obj_set_style_local_text_color(cal, LV_CALENDAR_PART_DATE, LV_STATE_DISABLED, LV_COLOR_MAKE(0x40, 0x40, 0x40));
+		style_pool_add_int(cal, LV_CALENDAR_PART_BG, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
+		style_pool_add_color(cal, LV_CALENDAR_PART_DATE, LV_STATE_DISABLED, LV_STYLE_TEXT_COLOR, LV_COLOR_MAKE(0x40, 0x40, 0x40));
 		lv_calendar_set_day_names(cal, day_names);
 		lv_calendar_set_month_names(cal, month_names);
 		lv_obj_set_size(cal, WIDTH, HEIGHT);
 		lv_obj_set_user_data(cal, this);
 		lv_obj_set_event_cb(cal, cal_cb);
 		lv_page_glue_obj(cal, true);
+		layer_cache_enable(cal); // changes once a day
 
 		// Make the date number smaller to be sure they fit into their area
 		//lv_obj_set_style_local_text_font(cal, LV_CALENDAR_PART_DATE, LV_STATE_DEFAULT, lv_theme_get_font_small());
 
 		// Set date
-		//update(2020, 9, 22);
+		if (today.year)
+		{
+			lv_calendar_set_today_date(cal, &today);
+			lv_calendar_set_showed_date(cal, &today);
+		}
+	}
+
+	virtual void forget()
+	{
+		cal = NULL;
 	}
 
 	void update(uint16_t year, uint16_t month, uint16_t day)
 	{
 		// Set today's date
-		lv_calendar_date_t today;
 		today.year = year;
 		today.month = (int8_t)month;
 		today.day = (int8_t)day;
 
-		lv_calendar_set_today_date(cal, &today);
-		lv_calendar_set_showed_date(cal, &today);
+		if (cal)
+		{
+			lv_calendar_set_today_date(cal, &today);
+			lv_calendar_set_showed_date(cal, &today);
+		}
 	}
 
 	static void cal_cb(lv_obj_t * obj, lv_event_t event)
@@ -644,6 +724,8 @@ public:
 	}
 
 private:
+	lv_calendar_date_t today;
+
 	// GUI
 	lv_obj_t *cal;
 };
@@ -679,6 +761,20 @@ public:
 		alarm_on = on;
 	}
 
+	virtual void save(my_watch_state_t *state)
+	{
+		state->alarm_hour = alarm_hour;
+		state->alarm_min  = alarm_min;
+		state->alarm_on   = alarm_on;
+	}
+
+	virtual void restore(const my_watch_state_t *state)
+	{
+		alarm_hour = state->alarm_hour;
+		alarm_min  = state->alarm_min;
+		alarm_on   = state->alarm_on;
+	}
+
 	void update(uint16_t weekday, uint16_t hour, uint16_t min)
 	{
 		if (alarm_on && (hour == alarm_hour) && (min == alarm_min))
@@ -698,30 +794,38 @@ private:
 class StopwatchTile : public BaseTile
 {
 public:
-	StopwatchTile() : start_ms(0) {}
+	StopwatchTile() : start_ms(0), label_time(NULL) {}
 
 	virtual void populate()
 	{
 		populate_label(name);
 
 		// time
-		lv_obj_t * label = lv_label_create(get_parent(), NULL);
+		lv_obj_t * label = num_label_create(get_parent());
 		lv_obj_add_style(label, LV_OBJ_PART_MAIN, &style_time);
 		label_time = label;
-		redraw(0);
+		redraw(start_ms ? diff_time(lv_tick_get(), start_ms) : 0);
 
 		populate_button("");
 		update_button();
 	}
 
+	virtual void forget()
+	{
+		label_time = NULL;
+	}
+
 	void redraw(uint32_t elapsed) // ms
 	{
+		if (!label_time)
+			return;
+
 		elapsed /= 10; // hund
 		uint32_t hund = elapsed % 100;
 		elapsed /= 100; // sec
 		uint32_t sec = elapsed % 60;
 		elapsed /= 60; // min
-		lv_label_set_text_fmt(label_time, "%d:%02d.%02d", elapsed, sec, hund);
+		num_label_set_text_fmt(label_time, "%d:%02d.%02d", elapsed, sec, hund);
 	}
 
 	virtual void button_start_press_cb()
@@ -780,6 +884,18 @@ public:
 		}
 	}
 
+	virtual void save(my_watch_state_t *state)
+	{
+		state->stopwatch_on = is_running();
+		state->stopwatch_ms = start_ms ? diff_time(lv_tick_get(), start_ms) : 0;
+	}
+
+	virtual void restore(const my_watch_state_t *state)
+	{
+		// continues counting from the saved time
+		start_ms = state->stopwatch_on ? LV_MATH_MAX(lv_tick_get() - state->stopwatch_ms, 1) : 0;
+	}
+
 private:
 	uint32_t start_ms;
 
@@ -797,9 +913,11 @@ class MetronomeTile : public BaseTile
 public:
 	MetronomeTile() : start_ms(0), delta_ms(0),
 		min_rpm(60), max_rpm(180), def_rpm(120), 
-		def_beat(4), curr_beat(0)
+		def_beat(4), curr_beat(0),
+		btnm(NULL), slider(NULL), slider_label(NULL)
 	{
 		num_beat = def_beat;
+		rpm = def_rpm;
 	}
 
 	#define NUM_METRO_LED 5
@@ -810,7 +928,7 @@ public:
 
 		// LED container
 		lv_obj_t * cont = lv_cont_create(get_parent(), NULL);
-		lv_obj_set_style_local_border_side(cont, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+		style_pool_add_int(cont, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
 		lv_cont_set_layout(cont, LV_LAYOUT_ROW_MID);
 		lv_cont_set_fit(cont, LV_FIT_TIGHT);
 		lv_page_glue_obj(cont, true);
@@ -830,14 +948,15 @@ public:
 		btnm_map[NUM_METRO_LED] = "";
 
 		btnm = lv_btnmatrix_create(get_parent(), NULL);
-		lv_obj_set_style_local_border_side(btnm, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+		style_pool_add_int(btnm, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
 		lv_obj_set_width_fit(btnm, WIDTH);
 		lv_obj_set_height_fit(btnm, HEIGHT / 4);
 		lv_page_glue_obj(btnm, true);
 		lv_btnmatrix_set_map(btnm, btnm_map);
+		uint16_t checked = is_running() ? num_beat - 1 : 0; // button of the beats
 		for (int i = 0; i < NUM_METRO_LED; i++)
 			lv_btnmatrix_set_btn_ctrl(btnm, i, 
-				LV_BTNMATRIX_CTRL_NO_REPEAT | LV_BTNMATRIX_CTRL_CHECKABLE | (i==0 ? LV_BTNMATRIX_CTRL_CHECK_STATE : 0));
+				LV_BTNMATRIX_CTRL_NO_REPEAT | LV_BTNMATRIX_CTRL_CHECKABLE | (i==checked ? LV_BTNMATRIX_CTRL_CHECK_STATE : 0));
 		lv_btnmatrix_set_btn_width(btnm, 0, 2);
 		lv_btnmatrix_set_one_check(btnm, true);
 		lv_obj_set_user_data(btnm, this);
@@ -845,7 +964,7 @@ public:
 
 		// slider container
 		cont = lv_cont_create(get_parent(), NULL);
-		lv_obj_set_style_local_border_side(cont, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_BORDER_SIDE_NONE);
+		style_pool_add_int(cont, LV_CONT_PART_MAIN, LV_STATE_DEFAULT, LV_STYLE_BORDER_SIDE, LV_BORDER_SIDE_NONE);
 		lv_cont_set_layout(cont, LV_LAYOUT_OFF);
 		lv_cont_set_fit(cont, LV_FIT_TIGHT);
 		lv_page_glue_obj(cont, true);
@@ -855,7 +974,7 @@ public:
 		lv_obj_set_width(slider, WIDTH*2/3);
 		lv_obj_align(slider, NULL, LV_ALIGN_CENTER, 0, 0);
 		lv_slider_set_range(slider, min_rpm, max_rpm);
-		lv_slider_set_value(slider, def_rpm, LV_ANIM_OFF);
+		lv_slider_set_value(slider, rpm, LV_ANIM_OFF);
 		lv_obj_set_user_data(slider, this);
 		lv_obj_set_event_cb(slider, slider_cb);
 
@@ -871,12 +990,21 @@ public:
 		lv_obj_set_style_local_value_ofs_y(slider, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, 25);
 
 #endif
-		speed_changed_cb(def_rpm);
+		speed_changed_cb(rpm);
 		redraw();
 	}
 
+	virtual void forget()
+	{
+		memset(led, 0, sizeof(led));
+		btnm = slider = slider_label = NULL;
+	}
+
 	void redraw()
 	{
+		if (!btnm)
+			return;
+
 		for (uint16_t i = 1; i <= NUM_METRO_LED; i++)
 		{
 			if (i == curr_beat)
@@ -926,6 +1054,15 @@ public:
 		redraw();
 	}
 
+	// as the "off" or the default beats button
+	void toggle()
+	{
+		int16_t beats = is_running() ? 0 : def_beat;
+		if (btnm)
+			lv_btnmatrix_set_btn_ctrl(btnm, beats ? beats - 1 : 0, LV_BTNMATRIX_CTRL_CHECK_STATE);
+		beats_changed_cb(beats);
+	}
+
 	static void slider_cb(lv_obj_t * obj, lv_event_t event)
 	{
 		if (event == LV_EVENT_VALUE_CHANGED)
@@ -947,12 +1084,13 @@ public:
 			rpm = max_rpm;
 
 		delta_ms = 60 * 1000 / rpm;
+		this->rpm = rpm;
 
 		static char buf[8];
 		lv_snprintf(buf, sizeof(buf), "%d rpm", rpm);
 		if (slider_label)
 			lv_label_set_static_text(slider_label, buf);
-		else
+		else if (slider)
 			lv_obj_set_style_local_value_str(slider, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, buf);
 	}
 
@@ -960,12 +1098,27 @@ public:
 	{
 		// reset speed
 		MY_LOG("reset speed");
-		lv_slider_set_value(slider, def_rpm, LV_ANIM_ON);
+		if (slider)
+			lv_slider_set_value(slider, def_rpm, LV_ANIM_ON);
 		speed_changed_cb(def_rpm);
 	}
 
 	inline bool is_running() { return (start_ms != 0); }
 
+	virtual void save(my_watch_state_t *state)
+	{
+		state->metro_rpm   = rpm;
+		state->metro_beats = is_running() ? num_beat : 0;
+	}
+
+	virtual void restore(const my_watch_state_t *state)
+	{
+		speed_changed_cb(state->metro_rpm); // limited
+		num_beat  = state->metro_beats ? state->metro_beats : def_beat;
+		start_ms  = state->metro_beats ? lv_tick_get() : 0;
+		curr_beat = state->metro_beats ? 1 : 0;
+	}
+
 	void update_ms(uint32_t curr_ms)
 	{
 		if (start_ms)
@@ -987,7 +1140,7 @@ public:
 
 private:
 	uint32_t start_ms, delta_ms;
-	int16_t min_rpm, max_rpm, def_rpm;
+	int16_t min_rpm, max_rpm, def_rpm, rpm;
 	int16_t num_beat, def_beat, curr_beat;
 
 	// GUI
@@ -1004,12 +1157,14 @@ private:
 class CountdownTile : public BaseTile
 {
 public:
+	CountdownTile() : cnt_hour(0), cnt_min(3), cnt_sec(0), cnt_on(0) {}
+
 	virtual void populate()
 	{
 		populate_label(name);
-		populate_hour_min_sec(0, 0, 0);
+		populate_hour_min_sec(cnt_hour, cnt_min, cnt_sec);
 		populate_button("");
-		reset();
+		update_button();
 	}
 
 	void reset()
@@ -1045,6 +1200,14 @@ public:
 		reset();
 	}
 
+	// as the button, restarted after it is done
+	void toggle()
+	{
+		if (!cnt_on && !cnt_hour && !cnt_min && !cnt_sec)
+			reset();
+		button_clicked_cb();
+	}
+
 	virtual void button_clicked_cb()
 	{
 		cnt_on = !cnt_on;
@@ -1057,6 +1220,22 @@ public:
 		set_button_text(cnt_on ? "stopp" : "start");
 	}
 
+	virtual void save(my_watch_state_t *state)
+	{
+		state->cnt_hour = cnt_hour;
+		state->cnt_min  = cnt_min;
+		state->cnt_sec  = cnt_sec;
+		state->cnt_on   = cnt_on;
+	}
+
+	virtual void restore(const my_watch_state_t *state)
+	{
+		cnt_hour = state->cnt_hour;
+		cnt_min  = state->cnt_min;
+		cnt_sec  = state->cnt_sec;
+		cnt_on   = state->cnt_on;
+	}
+
 	void update_sec(bool need_draw)
 	{
 		if (!cnt_on)
@@ -1154,6 +1333,18 @@ public:
 		set_arc_text(cnt_on ? "stopp" : "start");
 	}
 
+	virtual void save(my_watch_state_t *state)
+	{
+		state->brush_sec = cnt_sec;
+		state->brush_on  = cnt_on;
+	}
+
+	virtual void restore(const my_watch_state_t *state)
+	{
+		cnt_sec = (state->brush_sec < num_sec) ? state->brush_sec : 0;
+		cnt_on  = state->brush_on;
+	}
+
 	void update_sec(bool need_draw)
 	{
 		if (! cnt_on)
@@ -1194,7 +1385,7 @@ private:
 class LampTile : public BaseTile
 {
 public:
-	LampTile() {}
+	LampTile() : color(LV_COLOR_WHITE) {}
 
 	virtual void populate()
 	{
@@ -1204,7 +1395,7 @@ public:
 		lv_label_set_static_text(label, name);
 
 		// color picker
-		lv_color_t col = LV_COLOR_WHITE;
+		lv_color_t col = color;
 		lv_obj_t * cpicker = lv_cpicker_create(get_parent(), NULL);
 		lv_obj_set_style_local_pad_inner(cpicker, LV_CPICKER_PART_MAIN, LV_STATE_DEFAULT, 0);
 		lv_obj_set_style_local_border_color(cpicker, LV_CPICKER_PART_KNOB, LV_STATE_DEFAULT, LV_COLOR_BLACK);
@@ -1219,8 +1410,19 @@ public:
 		lv_obj_set_event_cb(cpicker, cpicker_cb);
 	}
 
+	virtual void save(my_watch_state_t *state)
+	{
+		state->lamp_color = lv_color_to32(color);
+	}
+
+	virtual void restore(const my_watch_state_t *state)
+	{
+		color = lv_color_hex(state->lamp_color & 0xFFFFFF);
+	}
+
 	inline void set_bg(lv_color_t col)
 	{
+		color = col;
 		lv_obj_set_style_local_bg_color(get_parent(), LV_CONT_PART_MAIN, LV_STATE_DEFAULT, col);
 	}
 
@@ -1255,6 +1457,8 @@ public:
 		}
 	}
 
+private:
+	lv_color_t color;
 };
 
 // ------------------------------------------------------------------------
@@ -1264,7 +1468,7 @@ public:
 class LevelTile : public BaseTile
 {
 public:
-	LevelTile() {}
+	LevelTile() : bubble(NULL) {}
 
 	virtual void populate()
 	{
@@ -1281,9 +1485,14 @@ public:
 		static lv_point_t vert[2]  = { {0, -HEIGHT / 2}, {0, HEIGHT / 2} };
 		
 		static lv_style_t style_line;
-		lv_style_init(&style_line);
-		lv_style_set_line_width(&style_line, LV_STATE_DEFAULT, 1);
-		lv_style_set_line_color(&style_line, LV_STATE_DEFAULT, LV_COLOR_GRAY);
+		static bool style_line_init = false;
+		if (!style_line_init) // once, the tile is created again
+		{
+			style_line_init = true;
+			lv_style_init(&style_line);
+			lv_style_set_line_width(&style_line, LV_STATE_DEFAULT, 1);
+			lv_style_set_line_color(&style_line, LV_STATE_DEFAULT, LV_COLOR_GRAY);
+		}
 
 		lv_obj_t * line = lv_line_create(get_parent(), NULL);
 		lv_obj_add_style(line, LV_LINE_PART_MAIN, &style_line);
@@ -1302,9 +1511,15 @@ public:
 		lv_obj_set_style_local_shadow_spread(led, LV_LED_PART_MAIN, LV_STATE_DEFAULT, 3);
 		lv_obj_set_size(led, 15, 15);
 		lv_obj_align(led, NULL, LV_ALIGN_CENTER, 0, 0);
+		draw_cache_attach_led(led); // redrawn on every move
 		bubble = led;
 	}
 
+	virtual void forget()
+	{
+		bubble = NULL;
+	}
+
 	void update(lv_coord_t x, lv_coord_t y)
 	{
 		if (bubble)
@@ -1360,8 +1575,35 @@ public:
 		return ((m % 2) == 0) ? 30 : 31;
 	}
 
+	virtual void save(my_watch_state_t *state)
+	{
+		state->hour    = hour;
+		state->min     = min;
+		state->sec     = sec;
+		state->weekday = weekday;
+		state->year    = year;
+		state->month   = month;
+		state->day     = day;
+	}
+
+	virtual void restore(const my_watch_state_t *state)
+	{
+		hour    = state->hour % 24;
+		min     = state->min % 60;
+		sec     = state->sec % 60;
+		weekday = state->weekday % 7;
+		year    = state->year;
+		month   = state->month;
+		day     = state->day;
+		day_changed = true;
+
+		if (cal)
+			cal->update(year, month, day);
+	}
+
 	void update_sec(bool need_draw)
 	{
+		MEM_PROFILE_SCOPE(name, __FUNCTION__);
 		sec += 1;
 		if (sec == 60)
 		{
@@ -1430,7 +1672,7 @@ public:
 		lv_obj_t * label;
 
 		// time
-		label = lv_label_create(get_parent(), NULL);
+		label = num_label_create(get_parent());
 		lv_obj_add_style(label, LV_OBJ_PART_MAIN, &style_time);
 		//lv_obj_align(label, NULL, LV_ALIGN_CENTER, 0, 0);
 		//lv_label_set_static_text(label, "23:59:48");
@@ -1449,25 +1691,39 @@ public:
 		//lv_obj_align(label, NULL, LV_ALIGN_CENTER, 0, 0);
 		//lv_label_set_static_text(label, "22.09.2020");
 		label_date = label;
+		txt_date.attach(label);
 
+		day_changed = true;
 		redraw();
 	}
 
+	virtual void forget()
+	{
+		label_time = label_weekday = label_date = NULL;
+	}
+
 	virtual void redraw()
 	{
-		lv_label_set_text_fmt(label_time, "%02d:%02d:%02d", hour, min, sec);
+		if (!label_time)
+			return;
+
+		area_merge_scenario("digital home");
+		ui_txn_begin(get_parent());
+		num_label_set_text_fmt(label_time, "%02d:%02d:%02d", hour, min, sec);
 
 		if (day_changed)
 		{
 			lv_label_set_static_text(label_weekday, (weekday < 7) ? weekday_names[weekday] : "???");
-			lv_label_set_text_fmt(label_date, "%02d.%02d.%04d", day, month, year);
+			txt_date.setTextFmt("%02d.%02d.%04d", day, month, year);
 			day_changed = false;
 		}
+		ui_txn_commit();
 	}
 
 private:
 	// GUI
 	lv_obj_t *label_time, *label_weekday, *label_date;
+	LabelText<12> txt_date;
 };
 
 class AnalogHomeTile : public HomeTile
@@ -1498,15 +1754,28 @@ public:
 		lv_img_set_src(img_sec, &hand_sec);
 		lv_obj_align(img_sec, NULL, LV_ALIGN_CENTER, 0, 0);
 
+		overdraw_attach(get_parent());
+
 		redraw();
 	}
 
+	virtual void forget()
+	{
+		img_bg = img_fig = img_hour = img_min = img_sec = NULL;
+	}
+
 	virtual void redraw()
 	{
+		if (!img_sec)
+			return;
+
+		area_merge_scenario("analog home");
+		ui_txn_begin(get_parent());
 		lv_img_set_angle(img_fig, (sec & 1) ? -25 : 25);
 		lv_img_set_angle(img_hour, (hour%12)*300+min*5);
 		lv_img_set_angle(img_min, min*60+sec);
 		lv_img_set_angle(img_sec, sec*60);
+		ui_txn_commit();
 	}
 
 private:
@@ -1532,6 +1801,7 @@ public:
 		lv_obj_set_event_cb(tv, tv_cb);
 
 		num_tiles = 0;
+		this->tv = tv;
 
 		lamp.create(tv, "Taschenlampe");
 		level.create(tv, "Wasserwaage");
@@ -1546,7 +1816,13 @@ public:
 		toothbrushing.create(tv, "Zahnputzen");
 		MY_LOG("Created %d tiles", num_tiles);
 
-		lv_tileview_set_valid_positions(tv, tile_pos, num_tiles);
+		// fixed size: the tiles keep their position while others are deleted
+		lv_obj_t * scrl = lv_page_get_scrollable(tv);
+		lv_page_set_scrollable_fit(tv, LV_FIT_NONE);
+		lv_obj_set_size(scrl, num_tiles * WIDTH, HEIGHT);
+
+		act_pos = pos_time_day;
+		update_window();
 		lv_tileview_set_edge_flash(tv, true);
 		lv_tileview_set_tile_act(tv, pos_time_day, 0, LV_ANIM_OFF);
 //		lv_tileview_set_tile_act(tv, 2, 0, LV_ANIM_OFF); // fixme
@@ -1584,6 +1860,65 @@ public:
 			set_normal_speed();
 		if ((new_pos == pos_stopwatch) && (stopwatch.is_running()))
 			set_high_speed();
+
+		// the new tile exists already, its neighbours after this frame
+		act_pos = new_pos;
+		lv_async_call(window_cb, this);
+	}
+
+	static void window_cb(void * user_data)
+	{
+		MainTileView *inst = (MainTileView *)user_data;
+		if (inst)
+			inst->update_window();
+	}
+
+	// create the tiles next to the active one, delete the others
+	void update_window()
+	{
+		uint32_t start = get_time_us();
+		uint16_t created = 0, deleted = 0;
+
+		for (BaseTile *t = BaseTile::get_first(); t; t = t->get_next())
+		{
+			if ((LV_MATH_ABS(t->get_pos() - act_pos) > TILE_WINDOW) && t->is_created())
+			{
+				t->depopulate(); // first, to keep the peak of the heap low
+				deleted++;
+			}
+		}
+		for (BaseTile *t = BaseTile::get_first(); t; t = t->get_next())
+		{
+			if ((LV_MATH_ABS(t->get_pos() - act_pos) <= TILE_WINDOW) && !t->is_created())
+			{
+				t->materialize();
+				created++;
+			}
+		}
+
+		// swiping reaches the tiles which exist
+		num_valid = 0;
+		valid_pos[num_valid].x = act_pos; // first: kept as active tile
+		valid_pos[num_valid++].y = 0;
+		for (lv_coord_t d = 1; d <= TILE_WINDOW; d++)
+		{
+			if (act_pos - d >= 0) {
+				valid_pos[num_valid].x = act_pos - d;
+				valid_pos[num_valid++].y = 0;
+			}
+			if (act_pos + d < num_tiles) {
+				valid_pos[num_valid].x = act_pos + d;
+				valid_pos[num_valid++].y = 0;
+			}
+		}
+		lv_tileview_set_valid_positions(tv, valid_pos, num_valid);
+
+		if (created || deleted)
+		{
+			uint32_t elapsed = get_time_us() - start;
+			MY_LOG("Tile %d: %d tiles created, %d deleted in %d us%s", act_pos, created, deleted, elapsed,
+				(elapsed > LV_DISP_DEF_REFR_PERIOD * 1000U) ? ", longer than a frame!" : "");
+		}
 	}
 
 	void check_sec(uint32_t curr_ms)
@@ -1594,11 +1929,11 @@ public:
 		num++;
 		//MY_LOG("my_task called at %d ms", curr_ms);
 
-		if (stopwatch.is_running() && lv_obj_is_visible(stopwatch.get_parent()))
+		if (stopwatch.is_running() && stopwatch.is_visible())
 		{
 			stopwatch.update_ms(curr_ms);
 		} 
-		else if (lv_obj_is_visible(level.get_parent()))
+		else if (level.is_visible())
 		{ 
 			// simulation
 			level.update(50 * sin(0.003*curr_ms), 50 * cos(0.005*curr_ms));
@@ -1611,14 +1946,64 @@ public:
 		if (elapsed >= 1000)
 		{
 			MY_LOG("my_task called %d times during 1s", num);
-			time_day.update_sec(num > 1);
-			countdown.update_sec(num > 1);
-			toothbrushing.update_sec(num > 1);
+			HeapCheck check("update_sec"); // not per call: the task runs on every pass
+			update_sec(num > 1);
 			last_ms += 1000;
 			num = 0;
 		}
 	}
 
+	void update_sec(bool need_draw)
+	{
+		time_day.update_sec(need_draw);
+		countdown.update_sec(need_draw);
+		toothbrushing.update_sec(need_draw);
+	}
+
+	void toggle_timer(my_watch_timer_t timer)
+	{
+		switch (timer)
+		{
+		case MY_WATCH_COUNTDOWN: countdown.toggle(); break;
+		case MY_WATCH_STOPWATCH: stopwatch.button_clicked_cb(); break;
+		case MY_WATCH_METRONOME: metronome.toggle(); break;
+		}
+	}
+
+	// as swiped by dir tiles, false if there is no tile
+	bool swipe(int16_t dir)
+	{
+		lv_coord_t pos = act_pos + dir;
+		if ((pos < 0) || (pos >= num_tiles))
+			return false;
+
+		lv_tileview_set_tile_act(tv, pos, 0, LV_ANIM_OFF); // valid if a neighbour
+		return true;
+	}
+
+	void get_state(my_watch_state_t *state)
+	{
+		memset(state, 0, sizeof(*state));
+		state->tile = act_pos;
+		for (BaseTile *t = BaseTile::get_first(); t; t = t->get_next())
+			t->save(state);
+	}
+
+	// as if the watch had been in that state: all tiles rebuilt
+	void set_state(const my_watch_state_t *state)
+	{
+		for (BaseTile *t = BaseTile::get_first(); t; t = t->get_next())
+		{
+			t->depopulate();
+			t->restore(state);
+		}
+
+		set_normal_speed();
+		act_pos = LV_MATH_MIN(LV_MATH_MAX(state->tile, 0), num_tiles - 1);
+		update_window();
+		lv_tileview_set_tile_act(tv, act_pos, 0, LV_ANIM_OFF);
+	}
+
 	static void task_cb(lv_task_t * task)
 	{
 		uint32_t curr_ms = task->last_run;
@@ -1628,8 +2013,13 @@ public:
 	}
 
 private:
+	lv_obj_t *tv;
+
 	// Tile positions
 	lv_coord_t pos_time_day, pos_stopwatch;
+	lv_coord_t act_pos;
+	lv_point_t valid_pos[2 * TILE_WINDOW + 1]; // used by the tileview
+	uint16_t num_valid;
 
 	// Tiles
 	CalendarTile calendar;
@@ -1648,9 +2038,12 @@ private:
 // MyWatch
 // ------------------------------------------------------------------------
 
+static MainTileView *main_tv;
+
 extern "C" void my_watch(void)
 {
 	static MainTileView mtv;
+	main_tv = &mtv;
 
 	set_normal_speed();
 
@@ -1658,6 +2051,56 @@ extern "C" void my_watch(void)
 	app  = NULL;
 
 	mtv.create(home);
+#if STYLE_POOL_REPORT
+	style_pool_report(home);
+#endif
+}
+
+// ------------------------------------------------------------------------
+// Soak benchmark
+// ------------------------------------------------------------------------
+
+extern "C" void my_watch_tick_sec(void)
+{
+	if (main_tv)
+		main_tv->update_sec(true);
+}
+
+extern "C" bool my_watch_swipe(int16_t dir)
+{
+	return main_tv && main_tv->swipe(dir);
+}
+
+extern "C" void my_watch_open_app(void)
+{
+	open_demo_app();
+}
+
+extern "C" void my_watch_close_app(void)
+{
+	close_demo_app();
+}
+
+extern "C" void my_watch_toggle_timer(my_watch_timer_t timer)
+{
+	if (main_tv)
+		main_tv->toggle_timer(timer);
+}
+
+// ------------------------------------------------------------------------
+// Hibernate
+// ------------------------------------------------------------------------
+
+extern "C" void my_watch_get_state(my_watch_state_t *state)
+{
+	if (main_tv)
+		main_tv->get_state(state);
+}
+
+extern "C" void my_watch_set_state(const my_watch_state_t *state)
+{
+	if (main_tv)
+		main_tv->set_state(state);
 }
 
 // ------------------------------------------------------------------------
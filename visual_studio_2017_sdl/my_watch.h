@@ -5,6 +5,9 @@
 #ifndef __MY_WATCH_H__
 #define __MY_WATCH_H__
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -14,6 +17,38 @@ void my_watch(void);
 void set_normal_speed(void);
 void set_high_speed(void);
 
+// soak benchmark: the watch driven in simulated time, without touch
+void my_watch_tick_sec(void);     // one second of the clocks and timers
+bool my_watch_swipe(int16_t dir); // to the next tile (dir -1 or 1)
+void my_watch_open_app(void);
+void my_watch_close_app(void);
+
+typedef enum
+{
+    MY_WATCH_COUNTDOWN,
+    MY_WATCH_STOPWATCH,
+    MY_WATCH_METRONOME
+} my_watch_timer_t;
+
+void my_watch_toggle_timer(my_watch_timer_t timer); // as its start/stop button
+
+// hibernate: the model of the tiles, without widgets
+typedef struct
+{
+    int16_t  tile; // active tile
+    uint16_t hour, min, sec;
+    uint16_t weekday, year, month, day;
+    uint16_t alarm_hour, alarm_min, alarm_on;
+    uint16_t cnt_hour, cnt_min, cnt_sec, cnt_on;
+    uint32_t stopwatch_ms; // elapsed while running
+    uint16_t stopwatch_on;
+    int16_t  metro_rpm, metro_beats; // 0 beats: off
+    uint16_t brush_sec, brush_on;
+    uint32_t lamp_color; // lv_color_to32()
+} my_watch_state_t;
+
+void my_watch_get_state(my_watch_state_t *state);
+void my_watch_set_state(const my_watch_state_t *state); // rebuilds the tiles
 
 #ifdef __cplusplus
 } // extern "C"
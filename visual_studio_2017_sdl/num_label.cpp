@@ -0,0 +1,211 @@
+// ------------------------------------------------------------------------
+// Numeric label: fixed glyph cells, only changed characters are redrawn
+// ------------------------------------------------------------------------
+//
+// An lv_label is re-measured, resized (and realigned by its container) and
+// fully invalidated on every new text. For a clock or a stopwatch, where
+// usually one or two digits change, this redraws the whole line in a 48 px
+// font. Here the text is laid out once into fixed cells; a new text with the
+// same shape (digits at the same positions) only invalidates the changed
+// cells, and the design callback draws the cells within the clip area.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "num_label.h"
+#include "draw_cache.h"
+
+#include <stdarg.h>
+
+typedef struct
+{
+    // no ext. of ancestor (lv_obj)
+    char text[NUM_LABEL_MAX_LEN + 1];
+    uint8_t len;
+    lv_coord_t digit_w;                     // cell width of all digits
+    lv_coord_t x_ofs[NUM_LABEL_MAX_LEN + 1]; // start of each cell, end of last
+} num_label_ext_t;
+
+static lv_signal_cb_t ancestor_signal;
+static lv_design_cb_t ancestor_design;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static inline bool is_digit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+static void get_cell_area(const lv_obj_t *label, uint8_t i, lv_area_t *area)
+{
+    num_label_ext_t *ext = (num_label_ext_t *)lv_obj_get_ext_attr(label);
+    area->x1 = label->coords.x1 + ext->x_ofs[i];
+    area->x2 = label->coords.x1 + ext->x_ofs[i + 1] - 1;
+    area->y1 = label->coords.y1;
+    area->y2 = label->coords.y2;
+}
+
+static void refr_layout(lv_obj_t *label)
+{
+    num_label_ext_t *ext = (num_label_ext_t *)lv_obj_get_ext_attr(label);
+    const lv_font_t *font = lv_obj_get_style_text_font(label, LV_OBJ_PART_MAIN);
+    lv_coord_t space = lv_obj_get_style_text_letter_space(label, LV_OBJ_PART_MAIN);
+
+    ext->digit_w = 0;
+    for (char c = '0'; c <= '9'; c++)
+        ext->digit_w = LV_MATH_MAX(ext->digit_w, lv_font_get_glyph_width(font, c, 0));
+
+    lv_coord_t x = 0;
+    for (uint8_t i = 0; i < ext->len; i++)
+    {
+        ext->x_ofs[i] = x;
+        x += is_digit(ext->text[i]) ? ext->digit_w : lv_font_get_glyph_width(font, (uint8_t)ext->text[i], 0);
+        x += space;
+    }
+    ext->x_ofs[ext->len] = x;
+
+    lv_obj_set_size(label, x, lv_font_get_line_height(font));
+    lv_obj_invalidate(label); // also if the size did not change
+}
+
+static lv_design_res_t num_label_design(lv_obj_t *label, const lv_area_t *clip_area, lv_design_mode_t mode)
+{
+    if (mode == LV_DESIGN_COVER_CHK)
+        return LV_DESIGN_RES_NOT_COVER;
+
+    if (mode != LV_DESIGN_DRAW_MAIN)
+        return ancestor_design(label, clip_area, mode);
+
+    ancestor_design(label, clip_area, mode); // background, if any
+
+    num_label_ext_t *ext = (num_label_ext_t *)lv_obj_get_ext_attr(label);
+
+    lv_draw_label_dsc_t dsc;
+    draw_cache_init_label_dsc(label, LV_OBJ_PART_MAIN, &dsc);
+    const lv_font_t *font = dsc.font;
+    dsc.letter_space = 0;
+
+    for (uint8_t i = 0; i < ext->len; i++)
+    {
+        lv_area_t cell, clip;
+        get_cell_area(label, i, &cell);
+        if (!_lv_area_intersect(&clip, &cell, clip_area))
+            continue;
+
+        if (is_digit(ext->text[i]))
+            cell.x1 += (ext->digit_w - lv_font_get_glyph_width(font, (uint8_t)ext->text[i], 0)) / 2;
+
+        char txt[2] = { ext->text[i], '\0' };
+        lv_draw_label(&cell, &clip, &dsc, txt, NULL);
+    }
+
+    return LV_DESIGN_RES_OK;
+}
+
+static lv_res_t num_label_signal(lv_obj_t *label, lv_signal_t sign, void *param)
+{
+    lv_res_t res = ancestor_signal(label, sign, param);
+    if (res != LV_RES_OK)
+        return res;
+
+    if (sign == LV_SIGNAL_GET_TYPE)
+        return lv_obj_handle_get_type_signal((lv_obj_type_t *)param, "num_label");
+
+    if (sign == LV_SIGNAL_STYLE_CHG)
+        refr_layout(label);
+
+    return res;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+lv_obj_t *num_label_create(lv_obj_t *parent)
+{
+    lv_obj_t *label = lv_obj_create(parent, NULL);
+    if (!label)
+        return NULL;
+
+    if (!ancestor_signal)
+        ancestor_signal = lv_obj_get_signal_cb(label);
+    if (!ancestor_design)
+        ancestor_design = lv_obj_get_design_cb(label);
+
+    num_label_ext_t *ext = (num_label_ext_t *)lv_obj_allocate_ext_attr(label, sizeof(num_label_ext_t));
+    if (!ext)
+    {
+        lv_obj_del(label);
+        return NULL;
+    }
+    memset(ext, 0, sizeof(num_label_ext_t));
+
+    lv_obj_set_signal_cb(label, num_label_signal);
+    lv_obj_set_design_cb(label, num_label_design);
+    lv_obj_set_click(label, false);
+
+    // look like a label (no background)
+    lv_obj_clean_style_list(label, LV_OBJ_PART_MAIN);
+    lv_theme_apply(label, LV_THEME_LABEL);
+
+    refr_layout(label);
+    return label;
+}
+
+void num_label_set_text(lv_obj_t *label, const char *text)
+{
+    num_label_ext_t *ext = (num_label_ext_t *)lv_obj_get_ext_attr(label);
+
+    size_t len = strlen(text);
+    if (len > NUM_LABEL_MAX_LEN)
+        len = NUM_LABEL_MAX_LEN;
+
+    bool same_shape = (len == ext->len);
+    for (uint8_t i = 0; same_shape && (i < len); i++)
+    {
+        if ((text[i] != ext->text[i]) && !(is_digit(text[i]) && is_digit(ext->text[i])))
+            same_shape = false;
+    }
+
+    if (!same_shape)
+    {
+        memcpy(ext->text, text, len);
+        ext->text[len] = '\0';
+        ext->len = (uint8_t)len;
+        refr_layout(label);
+        return;
+    }
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        if (text[i] == ext->text[i])
+            continue;
+
+        ext->text[i] = text[i];
+
+        lv_area_t cell;
+        get_cell_area(label, i, &cell);
+        lv_obj_invalidate_area(label, &cell);
+    }
+}
+
+void num_label_set_text_fmt(lv_obj_t *label, const char *fmt, ...)
+{
+    char text[NUM_LABEL_MAX_LEN + 1];
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    num_label_set_text(label, text);
+}
+
+const char *num_label_get_text(const lv_obj_t *label)
+{
+    num_label_ext_t *ext = (num_label_ext_t *)lv_obj_get_ext_attr(label);
+    return ext->text;
+}
+
+// ------------------------------------------------------------------------
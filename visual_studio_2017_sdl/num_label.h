@@ -0,0 +1,31 @@
+// ------------------------------------------------------------------------
+// Numeric label: fixed glyph cells, only changed characters are redrawn
+// ------------------------------------------------------------------------
+
+#ifndef __NUM_LABEL_H__
+#define __NUM_LABEL_H__
+
+#define NUM_LABEL_MAX_LEN 15 // characters
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// label like object, styled by the LV_OBJ_PART_MAIN text properties
+lv_obj_t *num_label_create(lv_obj_t *parent);
+
+// Digits are drawn centered in cells of the widest digit, other characters
+// in cells of their own width. If only digits changed, just their cells are
+// invalidated; otherwise the label is laid out (and resized) again.
+void num_label_set_text(lv_obj_t *label, const char *text);
+void num_label_set_text_fmt(lv_obj_t *label, const char *fmt, ...);
+
+const char *num_label_get_text(const lv_obj_t *label);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NUM_LABEL_H__
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,353 @@
+// ------------------------------------------------------------------------
+// Numeric roller: a range of numbers, only the visible rows are rendered
+// ------------------------------------------------------------------------
+//
+// An lv_roller copies its newline separated options into a label, measures
+// all of them and scrolls the tall label within a page. For 0..59 this is a
+// 170 byte string and a 60 row label per roller, and each animated step
+// invalidates and clips the whole label. Here the roller only keeps the
+// range, the format and a scroll offset; the design callback formats and
+// draws the (at most rows + 1) rows intersecting the clip area. Dragging,
+// clicking a row and the keys of a group behave as with an lv_roller.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "num_roller.h"
+#include "draw_cache.h"
+
+#define NUM_ROLLER_ANIM_TIME 200 // ms, to the selected row
+
+typedef struct
+{
+    // no ext. of ancestor (lv_obj)
+    lv_style_list_t style_sel;
+    const char *fmt;
+    int16_t min, max;
+    int16_t value;
+    uint8_t rows;
+    lv_coord_t row_h;       // line height and line space
+    lv_coord_t line_space;
+    lv_coord_t ofs;         // scroll position, (value - min) * row_h if not moving
+    lv_coord_t press_ofs;
+    lv_coord_t drag_sum;
+    bool dragged;
+} num_roller_ext_t;
+
+static lv_signal_cb_t ancestor_signal;
+static lv_design_cb_t ancestor_design;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static inline bool is_digit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+static void format(const num_roller_ext_t *ext, int16_t value, char *text)
+{
+    snprintf(text, NUM_ROLLER_TEXT_LEN + 1, ext->fmt, value);
+}
+
+// width of the text, digits as wide as the widest digit
+static lv_coord_t get_text_width(const char *text, const lv_font_t *font, lv_coord_t digit_w, lv_coord_t space)
+{
+    lv_coord_t w = 0;
+    for (const char *p = text; *p; p++)
+        w += (is_digit(*p) ? digit_w : lv_font_get_glyph_width(font, (uint8_t)*p, 0)) + space;
+    return w;
+}
+
+static void refr_layout(lv_obj_t *roller)
+{
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+    const lv_font_t *font = lv_obj_get_style_text_font(roller, NUM_ROLLER_PART_BG);
+    lv_coord_t space = lv_obj_get_style_text_letter_space(roller, NUM_ROLLER_PART_BG);
+
+    lv_coord_t digit_w = 0;
+    for (char c = '0'; c <= '9'; c++)
+        digit_w = LV_MATH_MAX(digit_w, lv_font_get_glyph_width(font, c, 0));
+
+    // the longest texts are at the ends of the range
+    char text[NUM_ROLLER_TEXT_LEN + 1];
+    format(ext, ext->min, text);
+    lv_coord_t w = get_text_width(text, font, digit_w, space);
+    format(ext, ext->max, text);
+    w = LV_MATH_MAX(w, get_text_width(text, font, digit_w, space));
+
+    ext->line_space = lv_obj_get_style_text_line_space(roller, NUM_ROLLER_PART_BG);
+    ext->row_h = lv_font_get_line_height(font) + ext->line_space;
+    ext->ofs = (ext->value - ext->min) * ext->row_h;
+
+    w += lv_obj_get_style_pad_left(roller, NUM_ROLLER_PART_BG) + lv_obj_get_style_pad_right(roller, NUM_ROLLER_PART_BG);
+    lv_obj_set_size(roller, w, ext->row_h * ext->rows);
+    lv_obj_invalidate(roller); // also if the size did not change
+}
+
+static void set_ofs(lv_obj_t *roller, lv_anim_value_t ofs)
+{
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+    if (ofs == ext->ofs)
+        return;
+
+    ext->ofs = ofs;
+    lv_obj_invalidate(roller); // just the visible rows
+}
+
+static void anim_exec(void *roller, lv_anim_value_t ofs)
+{
+    set_ofs((lv_obj_t *)roller, ofs);
+}
+
+static void set_value(lv_obj_t *roller, int16_t value, lv_anim_enable_t anim, bool notify)
+{
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+    value = LV_MATH_MAX(ext->min, LV_MATH_MIN(ext->max, value));
+
+    bool changed = (value != ext->value);
+    ext->value = value;
+
+    lv_coord_t ofs = (value - ext->min) * ext->row_h;
+    lv_anim_del(roller, (lv_anim_exec_xcb_t)anim_exec);
+    if ((anim == LV_ANIM_OFF) || (ofs == ext->ofs))
+        set_ofs(roller, ofs);
+    else
+    {
+        lv_anim_path_t path;
+        lv_anim_path_init(&path);
+        lv_anim_path_set_cb(&path, lv_anim_path_ease_out);
+
+        lv_anim_t a;
+        lv_anim_init(&a);
+        lv_anim_set_var(&a, roller);
+        lv_anim_set_exec_cb(&a, (lv_anim_exec_xcb_t)anim_exec);
+        lv_anim_set_values(&a, ext->ofs, ofs);
+        lv_anim_set_time(&a, NUM_ROLLER_ANIM_TIME);
+        lv_anim_set_path(&a, &path);
+        lv_anim_start(&a);
+    }
+
+    if (changed && notify)
+    {
+        uint32_t id = value - ext->min; // as lv_roller
+        lv_event_send(roller, LV_EVENT_VALUE_CHANGED, &id);
+    }
+}
+
+// the rows intersecting the clip area, centered
+static void draw_rows(lv_obj_t *roller, const lv_area_t *clip, lv_draw_label_dsc_t *dsc)
+{
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+
+    // top of the row of min
+    lv_coord_t y0 = roller->coords.y1 + (lv_obj_get_height(roller) - ext->row_h) / 2 - ext->ofs;
+    int32_t first = (clip->y1 > y0) ? (clip->y1 - y0) / ext->row_h : 0;
+    int32_t last = (clip->y2 >= y0) ? (clip->y2 - y0) / ext->row_h : -1;
+    last = LV_MATH_MIN(last, ext->max - ext->min);
+
+    char text[NUM_ROLLER_TEXT_LEN + 1];
+    for (int32_t i = first; i <= last; i++)
+    {
+        lv_area_t area;
+        area.x1 = roller->coords.x1;
+        area.x2 = roller->coords.x2;
+        area.y1 = y0 + i * ext->row_h + ext->line_space / 2;
+        area.y2 = area.y1 + ext->row_h - ext->line_space - 1;
+
+        format(ext, (int16_t)(ext->min + i), text);
+        lv_draw_label(&area, clip, dsc, text, NULL);
+    }
+}
+
+static lv_design_res_t num_roller_design(lv_obj_t *roller, const lv_area_t *clip_area, lv_design_mode_t mode)
+{
+    if (mode != LV_DESIGN_DRAW_MAIN)
+        return ancestor_design(roller, clip_area, mode);
+
+    lv_draw_rect_dsc_t rect;
+    draw_cache_init_rect_dsc(roller, NUM_ROLLER_PART_BG, &rect);
+    lv_draw_rect(&roller->coords, clip_area, &rect);
+
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+    lv_area_t sel = roller->coords;
+    sel.y1 += (lv_obj_get_height(roller) - ext->row_h) / 2;
+    sel.y2 = sel.y1 + ext->row_h - 1;
+
+    // unselected rows above and below
+    lv_draw_label_dsc_t label;
+    draw_cache_init_label_dsc(roller, NUM_ROLLER_PART_BG, &label);
+    label.flag |= LV_TXT_FLAG_CENTER;
+
+    lv_area_t area, clip;
+    area = roller->coords;
+    area.y2 = sel.y1 - 1;
+    if (_lv_area_intersect(&clip, &area, clip_area))
+        draw_rows(roller, &clip, &label);
+
+    area = roller->coords;
+    area.y1 = sel.y2 + 1;
+    if (_lv_area_intersect(&clip, &area, clip_area))
+        draw_rows(roller, &clip, &label);
+
+    // selected row
+    if (_lv_area_intersect(&clip, &sel, clip_area))
+    {
+        draw_cache_init_rect_dsc(roller, NUM_ROLLER_PART_SELECTED, &rect);
+        lv_draw_rect(&sel, &clip, &rect);
+
+        draw_cache_init_label_dsc(roller, NUM_ROLLER_PART_SELECTED, &label);
+        label.flag |= LV_TXT_FLAG_CENTER;
+        draw_rows(roller, &clip, &label);
+    }
+
+    return LV_DESIGN_RES_OK;
+}
+
+static lv_res_t num_roller_signal(lv_obj_t *roller, lv_signal_t sign, void *param)
+{
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+
+    if (sign == LV_SIGNAL_GET_STYLE)
+    {
+        lv_get_style_info_t *info = (lv_get_style_info_t *)param;
+        if (info->part != NUM_ROLLER_PART_SELECTED)
+            return ancestor_signal(roller, sign, param);
+        info->result = &ext->style_sel;
+        return LV_RES_OK;
+    }
+
+    lv_res_t res = ancestor_signal(roller, sign, param);
+    if (res != LV_RES_OK)
+        return res;
+
+    if (sign == LV_SIGNAL_GET_TYPE)
+        return lv_obj_handle_get_type_signal((lv_obj_type_t *)param, "num_roller");
+
+    if (sign == LV_SIGNAL_CLEANUP)
+    {
+        lv_anim_del(roller, (lv_anim_exec_xcb_t)anim_exec);
+        _lv_obj_reset_style_list_no_refr(roller, NUM_ROLLER_PART_SELECTED);
+    }
+    else if (sign == LV_SIGNAL_STYLE_CHG)
+        refr_layout(roller);
+    else if (sign == LV_SIGNAL_PRESSED)
+    {
+        lv_anim_del(roller, (lv_anim_exec_xcb_t)anim_exec);
+        ext->press_ofs = ext->ofs;
+        ext->drag_sum = 0;
+        ext->dragged = false;
+    }
+    else if (sign == LV_SIGNAL_PRESSING)
+    {
+        lv_point_t vect;
+        lv_indev_get_vect(lv_indev_get_act(), &vect);
+        ext->drag_sum += vect.y;
+        if (LV_MATH_ABS(ext->drag_sum) > LV_INDEV_DEF_DRAG_LIMIT)
+            ext->dragged = true;
+
+        if (ext->dragged)
+        {
+            // half a row beyond the ends
+            lv_coord_t ofs = ext->press_ofs - ext->drag_sum;
+            ofs = LV_MATH_MAX(-ext->row_h / 2, LV_MATH_MIN((ext->max - ext->min) * ext->row_h + ext->row_h / 2, ofs));
+            set_ofs(roller, ofs);
+        }
+    }
+    else if ((sign == LV_SIGNAL_RELEASED) || (sign == LV_SIGNAL_PRESS_LOST))
+    {
+        lv_coord_t ofs = ext->ofs;
+        if ((sign == LV_SIGNAL_RELEASED) && !ext->dragged)
+        {
+            // clicked row
+            lv_point_t p;
+            lv_indev_get_point(lv_indev_get_act(), &p);
+            ofs += p.y - (roller->coords.y1 + lv_obj_get_height(roller) / 2);
+        }
+        // nearest row, clamped to the range
+        lv_coord_t row = (ofs + ext->row_h / 2) / ext->row_h;
+        set_value(roller, (int16_t)(ext->min + row), LV_ANIM_ON, true);
+    }
+    else if (sign == LV_SIGNAL_CONTROL)
+    {
+        uint32_t key = *(uint32_t *)param;
+        if ((key == LV_KEY_DOWN) || (key == LV_KEY_RIGHT))
+            set_value(roller, ext->value + 1, LV_ANIM_ON, true);
+        else if ((key == LV_KEY_UP) || (key == LV_KEY_LEFT))
+            set_value(roller, ext->value - 1, LV_ANIM_ON, true);
+    }
+    else if (sign == LV_SIGNAL_GET_EDITABLE)
+        *(bool *)param = true;
+
+    return res;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+lv_obj_t *num_roller_create(lv_obj_t *parent)
+{
+    lv_obj_t *roller = lv_obj_create(parent, NULL);
+    if (!roller)
+        return NULL;
+
+    if (!ancestor_signal)
+        ancestor_signal = lv_obj_get_signal_cb(roller);
+    if (!ancestor_design)
+        ancestor_design = lv_obj_get_design_cb(roller);
+
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_allocate_ext_attr(roller, sizeof(num_roller_ext_t));
+    if (!ext)
+    {
+        lv_obj_del(roller);
+        return NULL;
+    }
+    memset(ext, 0, sizeof(num_roller_ext_t));
+    lv_style_list_init(&ext->style_sel);
+    ext->fmt = "%d";
+    ext->max = 9;
+    ext->rows = 3;
+
+    lv_obj_set_signal_cb(roller, num_roller_signal);
+    lv_obj_set_design_cb(roller, num_roller_design);
+
+    // look like a roller
+    lv_obj_clean_style_list(roller, NUM_ROLLER_PART_BG);
+    lv_theme_apply(roller, LV_THEME_ROLLER);
+
+    refr_layout(roller);
+    return roller;
+}
+
+void num_roller_set_range(lv_obj_t *roller, int16_t min, int16_t max, const char *fmt)
+{
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+    ext->min = min;
+    ext->max = LV_MATH_MAX(min, max);
+    ext->fmt = fmt;
+    ext->value = LV_MATH_MAX(ext->min, LV_MATH_MIN(ext->max, ext->value));
+
+    lv_anim_del(roller, (lv_anim_exec_xcb_t)anim_exec);
+    refr_layout(roller);
+}
+
+void num_roller_set_visible_row_count(lv_obj_t *roller, uint8_t rows)
+{
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+    ext->rows = rows;
+    refr_layout(roller);
+}
+
+void num_roller_set_value(lv_obj_t *roller, int16_t value, lv_anim_enable_t anim)
+{
+    set_value(roller, value, anim, false);
+}
+
+int16_t num_roller_get_value(const lv_obj_t *roller)
+{
+    num_roller_ext_t *ext = (num_roller_ext_t *)lv_obj_get_ext_attr(roller);
+    return ext->value;
+}
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,40 @@
+// ------------------------------------------------------------------------
+// Numeric roller: a range of numbers, only the visible rows are rendered
+// ------------------------------------------------------------------------
+
+#ifndef __NUM_ROLLER_H__
+#define __NUM_ROLLER_H__
+
+#define NUM_ROLLER_TEXT_LEN 15 // characters of a formatted value
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// styled like an lv_roller by the theme (LV_THEME_ROLLER)
+enum
+{
+    NUM_ROLLER_PART_BG = LV_ROLLER_PART_BG,
+    NUM_ROLLER_PART_SELECTED = LV_ROLLER_PART_SELECTED,
+};
+
+// roller like object for the values 0..9, see num_roller_set_range()
+lv_obj_t *num_roller_create(lv_obj_t *parent);
+
+// Values min..max, each formatted by fmt (e.g. "%02d", must stay valid) when
+// its row is drawn. No option string is built, the memory per roller and the
+// cost of a redraw do not depend on the range.
+void num_roller_set_range(lv_obj_t *roller, int16_t min, int16_t max, const char *fmt);
+void num_roller_set_visible_row_count(lv_obj_t *roller, uint8_t rows);
+
+// As lv_roller_set_selected(), but by value; clamped to the range
+void num_roller_set_value(lv_obj_t *roller, int16_t value, lv_anim_enable_t anim);
+int16_t num_roller_get_value(const lv_obj_t *roller);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __NUM_ROLLER_H__
+
+// ------------------------------------------------------------------------
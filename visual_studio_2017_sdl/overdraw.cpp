@@ -0,0 +1,281 @@
+// ------------------------------------------------------------------------
+// Overdraw analysis
+// ------------------------------------------------------------------------
+//
+// The design callbacks of the attached objects are wrapped. Every time an
+// object draws its main part, the pixels of its (extended) area within the
+// clip area are counted in a per-pixel buffer. At the end of each frame the
+// buffer is folded into a histogram and a peak map.
+//
+// Note: the counts are based on the bounding box of an object, so e.g.
+// rotated images with transparent corners count as full rectangles.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "overdraw.h"
+#include "app_arena.h"
+
+#if USE_OVERDRAW
+
+#include <stdio.h>
+
+#define OVERDRAW_MAX_OBJ 64
+#define OVERDRAW_MAX_CNT  8 // histogram: 1, 2, ..., 8+ writes
+
+typedef struct
+{
+    lv_obj_t *obj;
+    lv_design_cb_t design_cb; // original
+    const char *type;
+    uint32_t px_written;      // all pixel writes
+    uint32_t px_overdrawn;    // writes onto pixels already written in the same frame
+} overdraw_obj_t;
+
+static overdraw_obj_t objs[OVERDRAW_MAX_OBJ];
+static uint16_t num_objs;
+
+static uint8_t frame_cnt[LV_HOR_RES_MAX * LV_VER_RES_MAX]; // writes in current frame
+static uint8_t peak_cnt[LV_HOR_RES_MAX * LV_VER_RES_MAX];  // max. writes of all frames
+static uint32_t hist[OVERDRAW_MAX_CNT + 1];                // pixels by writes per frame
+static uint32_t num_frames;
+static bool frame_dirty;
+
+static lv_task_t *report_task;
+
+// heat map colors for 0, 1, ..., 8+ writes
+static const uint8_t palette[OVERDRAW_MAX_CNT + 1][3] = {
+    {   0,   0,   0 }, {   0,  64, 160 }, {   0, 160,  64 },
+    { 160, 200,   0 }, { 255, 160,   0 }, { 255,  64,   0 },
+    { 255,   0,   0 }, { 255,   0, 160 }, { 255, 255, 255 }
+};
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static overdraw_obj_t *find_obj(const lv_obj_t *obj)
+{
+    for (uint16_t i = 0; i < num_objs; i++)
+    {
+        if (objs[i].obj == obj)
+            return &objs[i];
+    }
+    return NULL;
+}
+
+static void count_area(overdraw_obj_t *o, const lv_area_t *clip_area)
+{
+    lv_area_t area;
+    lv_obj_get_coords(o->obj, &area);
+    area.x1 -= o->obj->ext_draw_pad;
+    area.y1 -= o->obj->ext_draw_pad;
+    area.x2 += o->obj->ext_draw_pad;
+    area.y2 += o->obj->ext_draw_pad;
+
+    lv_area_t draw;
+    if (!_lv_area_intersect(&draw, &area, clip_area))
+        return;
+
+    for (lv_coord_t y = draw.y1; y <= draw.y2; y++)
+    {
+        uint8_t *cnt = &frame_cnt[y * LV_HOR_RES_MAX + draw.x1];
+        for (lv_coord_t x = draw.x1; x <= draw.x2; x++, cnt++)
+        {
+            if (*cnt)
+                o->px_overdrawn++;
+            if (*cnt < UINT8_MAX)
+                (*cnt)++;
+        }
+    }
+    o->px_written += lv_area_get_size(&draw);
+    frame_dirty = true;
+}
+
+static lv_design_res_t overdraw_design(lv_obj_t *obj, const lv_area_t *clip_area, lv_design_mode_t mode)
+{
+    overdraw_obj_t *o = find_obj(obj);
+    if (!o)
+        return LV_DESIGN_RES_NOT_COVER;
+
+    if (mode == LV_DESIGN_DRAW_MAIN)
+        count_area(o, clip_area);
+
+    return o->design_cb(obj, clip_area, mode);
+}
+
+static void attach_obj(lv_obj_t *obj)
+{
+    if (lv_obj_get_design_cb(obj) == overdraw_design)
+        return; // already attached
+
+    // a stale entry of a deleted object at the same address is reused
+    overdraw_obj_t *o = find_obj(obj);
+    if (!o)
+    {
+        if (num_objs >= OVERDRAW_MAX_OBJ)
+        {
+            MY_LOG("Overdraw: too many objects");
+            return;
+        }
+        o = &objs[num_objs++];
+    }
+
+    lv_obj_type_t type;
+    lv_obj_get_type(obj, &type);
+
+    o->obj = obj;
+    o->design_cb = lv_obj_get_design_cb(obj);
+    o->type = type.type[0]; // static string
+    o->px_written = 0;
+    o->px_overdrawn = 0;
+    lv_obj_set_design_cb(obj, overdraw_design);
+}
+
+static void attach_tree(lv_obj_t *obj)
+{
+    attach_obj(obj);
+
+    lv_obj_t *child = lv_obj_get_child(obj, NULL);
+    while (child)
+    {
+        attach_tree(child);
+        child = lv_obj_get_child(obj, child);
+    }
+}
+
+static void write_image(const char *file)
+{
+    FILE *fp = fopen(file, "wb");
+    if (!fp)
+    {
+        MY_LOG("Overdraw: cannot write %s", file);
+        return;
+    }
+
+    fprintf(fp, "P6\n%d %d\n255\n", LV_HOR_RES_MAX, LV_VER_RES_MAX);
+    for (uint32_t i = 0; i < LV_HOR_RES_MAX * LV_VER_RES_MAX; i++)
+    {
+        uint8_t cnt = peak_cnt[i];
+        if (cnt > OVERDRAW_MAX_CNT)
+            cnt = OVERDRAW_MAX_CNT;
+        fwrite(palette[cnt], 1, 3, fp);
+    }
+    fclose(fp);
+    MY_LOG("Overdraw: heat map written to %s", file);
+}
+
+static void report_task_cb(lv_task_t *task)
+{
+    overdraw_report(OVERDRAW_FILE);
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+void overdraw_attach(lv_obj_t *root)
+{
+    if (!root)
+        return;
+
+    attach_tree(root);
+
+    // backgrounds below the root
+    for (lv_obj_t *par = lv_obj_get_parent(root); par; par = lv_obj_get_parent(par))
+        attach_obj(par);
+
+    if (!report_task)
+    {
+        app_arena_begin(NULL); // outlives the screen being populated
+        report_task = lv_task_create(report_task_cb, OVERDRAW_REPORT_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+        app_arena_end();
+    }
+}
+
+void overdraw_frame_done(void)
+{
+    if (!frame_dirty)
+        return;
+
+    for (uint32_t i = 0; i < LV_HOR_RES_MAX * LV_VER_RES_MAX; i++)
+    {
+        uint8_t cnt = frame_cnt[i];
+        if (!cnt)
+            continue;
+
+        hist[(cnt < OVERDRAW_MAX_CNT) ? cnt : OVERDRAW_MAX_CNT]++;
+        if (cnt > peak_cnt[i])
+            peak_cnt[i] = cnt;
+        frame_cnt[i] = 0;
+    }
+
+    num_frames++;
+    frame_dirty = false;
+}
+
+void overdraw_report(const char *file)
+{
+    uint32_t drawn = 0, writes = 0;
+    for (uint16_t cnt = 1; cnt <= OVERDRAW_MAX_CNT; cnt++)
+    {
+        drawn  += hist[cnt];
+        writes += hist[cnt] * cnt;
+    }
+    if (!drawn)
+    {
+        MY_LOG("Overdraw: nothing drawn");
+        return;
+    }
+
+    uint32_t ratio = writes * 100 / drawn;
+    MY_LOG("Overdraw after %d frames: %d px drawn, %d.%02d writes/px",
+        num_frames, drawn, ratio / 100, ratio % 100);
+    for (uint16_t cnt = 1; cnt <= OVERDRAW_MAX_CNT; cnt++)
+    {
+        MY_LOG("  %d%s writes: %7d px (%d%%)", cnt, (cnt == OVERDRAW_MAX_CNT) ? "+" : " ",
+            hist[cnt], hist[cnt] * 100 / drawn);
+    }
+
+    // objects sorted by overdrawn pixels, worst first
+    bool listed[OVERDRAW_MAX_OBJ] = { false };
+    MY_LOG("  %-12s %10s %10s", "object", "written", "overdrawn");
+    for (uint16_t n = 0; n < num_objs; n++)
+    {
+        int16_t worst = -1;
+        for (uint16_t i = 0; i < num_objs; i++)
+        {
+            if (listed[i] || !objs[i].px_written)
+                continue;
+            if ((worst < 0) || (objs[i].px_overdrawn > objs[worst].px_overdrawn))
+                worst = i;
+        }
+        if (worst < 0)
+            break;
+
+        listed[worst] = true;
+        MY_LOG("  %-12s %10d %10d  (%p)", objs[worst].type,
+            objs[worst].px_written, objs[worst].px_overdrawn, (void *)objs[worst].obj);
+    }
+
+    if (file)
+        write_image(file);
+}
+
+void overdraw_reset(void)
+{
+    memset(frame_cnt, 0, sizeof(frame_cnt));
+    memset(peak_cnt, 0, sizeof(peak_cnt));
+    memset(hist, 0, sizeof(hist));
+    num_frames = 0;
+    frame_dirty = false;
+
+    for (uint16_t i = 0; i < num_objs; i++)
+    {
+        objs[i].px_written = 0;
+        objs[i].px_overdrawn = 0;
+    }
+}
+
+#endif // USE_OVERDRAW
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,48 @@
+// ------------------------------------------------------------------------
+// Overdraw analysis
+// ------------------------------------------------------------------------
+
+#ifndef __OVERDRAW_H__
+#define __OVERDRAW_H__
+
+// 1: count the pixel writes of attached objects per frame (slow, for analysis only)
+#ifndef USE_OVERDRAW
+#define USE_OVERDRAW 0
+#endif
+
+// period of the report written to the log and to OVERDRAW_FILE
+#define OVERDRAW_REPORT_PERIOD 10000 // ms
+#define OVERDRAW_FILE          "overdraw.ppm"
+
+#if USE_OVERDRAW
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// instrument the object, its children and its ancestors up to the screen
+void overdraw_attach(lv_obj_t *root);
+
+// call at the end of each display refresh (e.g. from the monitor_cb)
+void overdraw_frame_done(void);
+
+// log histogram and worst objects, write heat map as PPM image (file may be NULL)
+void overdraw_report(const char *file);
+void overdraw_reset(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define overdraw_attach(root)
+#define overdraw_frame_done()
+#define overdraw_report(file)
+#define overdraw_reset()
+
+#endif // USE_OVERDRAW
+
+#endif // __OVERDRAW_H__
+
+// ------------------------------------------------------------------------
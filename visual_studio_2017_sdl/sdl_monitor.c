@@ -0,0 +1,298 @@
+/**
+ * @file sdl_monitor.c
+ * SDL monitor with partial texture upload.
+ * Each flushed area is uploaded into its rectangle of a streaming texture
+ * and the frame is presented once per refresh (see `sdl_monitor_present`).
+ * Run with `SDL_VIDEODRIVER=dummy` to measure the upload cost offscreen.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "sdl_monitor.h"
+
+#if USE_MONITOR && MONITOR_PARTIAL_UPLOAD
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include MONITOR_SDL_INCLUDE_PATH
+#include "lv_drivers/indev/mouse.h"
+#include "lv_drivers/indev/mousewheel.h"
+#include "lv_drivers/indev/keyboard.h"
+
+#if MONITOR_DOUBLE_BUFFERED || MONITOR_DUAL
+#error "MONITOR_PARTIAL_UPLOAD requires MONITOR_DOUBLE_BUFFERED 0 and MONITOR_DUAL 0"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#if LV_COLOR_DEPTH == 32
+#  define TEXTURE_FORMAT    SDL_PIXELFORMAT_ARGB8888
+#elif LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0
+#  define TEXTURE_FORMAT    SDL_PIXELFORMAT_RGB565
+#else
+#  error "MONITOR_PARTIAL_UPLOAD supports LV_COLOR_DEPTH 32 and 16 (not swapped) only"
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void sdl_event_handler(lv_task_t * task);
+static void sdl_stats_task(lv_task_t * task);
+static void sdl_clean_up(void);
+static uint64_t elapsed_us(Uint64 start);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static SDL_Window * window;
+static SDL_Renderer * renderer;
+static SDL_Texture * texture;
+static bool present_qry;
+static sdl_monitor_stats_t stats;
+static void (*quit_cb)(void);
+#if MONITOR_SHADOW
+static lv_color_t shadow[LV_HOR_RES_MAX * LV_VER_RES_MAX];
+#endif
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Create the window, the renderer and the streaming texture
+ */
+void sdl_monitor_init(void)
+{
+    SDL_Init(SDL_INIT_VIDEO);
+
+    window = SDL_CreateWindow("TFT Simulator",
+                              SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                              MONITOR_HOR_RES * MONITOR_ZOOM, MONITOR_VER_RES * MONITOR_ZOOM, 0);
+
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    texture = SDL_CreateTexture(renderer, TEXTURE_FORMAT, SDL_TEXTUREACCESS_STREAMING,
+                                MONITOR_HOR_RES, MONITOR_VER_RES);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+
+    if(window == NULL || renderer == NULL || texture == NULL) {
+        printf("SDL monitor init failed: %s\n", SDL_GetError());
+        exit(1);
+    }
+
+    lv_task_create(sdl_event_handler, 10, LV_TASK_PRIO_HIGH, NULL);
+#if MONITOR_STATS_PERIOD
+    lv_task_create(sdl_stats_task, MONITOR_STATS_PERIOD, LV_TASK_PRIO_LOWEST, NULL);
+#endif
+}
+
+/**
+ * Flush a buffer to its rectangle of the texture.
+ * The frame is not presented here, call `sdl_monitor_present` at the end of the refresh.
+ * @param disp_drv the display driver
+ * @param area an area where to copy `color_p`
+ * @param color_p an array of pixel to copy to the `area` part of the screen
+ */
+void sdl_monitor_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    lv_coord_t hres = disp_drv->hor_res;
+    lv_coord_t vres = disp_drv->ver_res;
+
+    /*Return if the area is out the screen*/
+    if(area->x2 < 0 || area->y2 < 0 || area->x1 > hres - 1 || area->y1 > vres - 1) {
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+
+    SDL_Rect rect;
+    rect.x = area->x1;
+    rect.y = area->y1;
+    rect.w = lv_area_get_width(area);
+    rect.h = lv_area_get_height(area);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    SDL_UpdateTexture(texture, &rect, color_p, rect.w * sizeof(lv_color_t));
+    stats.upload_us += elapsed_us(start);
+
+#if MONITOR_SHADOW
+    /*Keep the visible part of the area*/
+    lv_coord_t x1 = LV_MATH_MAX(area->x1, 0);
+    lv_coord_t x2 = LV_MATH_MIN(area->x2, LV_HOR_RES_MAX - 1);
+    lv_coord_t y;
+    for(y = LV_MATH_MAX(area->y1, 0); y <= LV_MATH_MIN(area->y2, LV_VER_RES_MAX - 1); y++) {
+        memcpy(&shadow[y * LV_HOR_RES_MAX + x1], &color_p[(y - area->y1) * rect.w + (x1 - area->x1)],
+               (x2 - x1 + 1) * sizeof(lv_color_t));
+    }
+#endif
+
+    stats.flushes++;
+    stats.px_uploaded += (uint64_t)rect.w * rect.h;
+    present_qry = true;
+
+    /*IMPORTANT! It must be called to tell the system the flush is ready*/
+    lv_disp_flush_ready(disp_drv);
+}
+
+/**
+ * Present the texture if something was flushed since the last call.
+ * Called at the end of each refresh (e.g. from the `monitor_cb` of the driver)
+ * so all areas of a refresh are shown with a single present.
+ */
+void sdl_monitor_present(void)
+{
+    if(!present_qry) return;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+    stats.present_us += elapsed_us(start);
+
+    stats.presents++;
+    present_qry = false;
+}
+
+/**
+ * Get the upload statistics since the last reset
+ * @param stats_p pointer to store the statistics
+ */
+void sdl_monitor_get_stats(sdl_monitor_stats_t * stats_p)
+{
+    *stats_p = stats;
+}
+
+void sdl_monitor_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * Set a function called when the window is closed, before the simulator exits
+ * @param cb the function, NULL: none
+ */
+void sdl_monitor_set_quit_cb(void (*cb)(void))
+{
+    quit_cb = cb;
+}
+
+#if MONITOR_SHADOW
+/**
+ * Get the last flushed frame
+ * @return LV_HOR_RES_MAX x LV_VER_RES_MAX pixels
+ */
+const lv_color_t * sdl_monitor_get_frame(void)
+{
+    return shadow;
+}
+
+/**
+ * Present a whole frame at once, without LVGL (e.g. a frame saved before)
+ * @param frame LV_HOR_RES_MAX x LV_VER_RES_MAX pixels
+ */
+void sdl_monitor_show_frame(const lv_color_t * frame)
+{
+    if(frame != shadow) memcpy(shadow, frame, sizeof(shadow));
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    SDL_UpdateTexture(texture, NULL, shadow, LV_HOR_RES_MAX * sizeof(lv_color_t));
+    stats.upload_us += elapsed_us(start);
+
+    stats.flushes++;
+    stats.px_uploaded += (uint64_t)LV_HOR_RES_MAX * LV_VER_RES_MAX;
+    present_qry = true;
+    sdl_monitor_present();
+}
+#endif
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Handle the SDL events: input devices, window exposure and quit
+ */
+static void sdl_event_handler(lv_task_t * task)
+{
+    (void)task;
+
+    SDL_Event event;
+    while(SDL_PollEvent(&event)) {
+#if USE_MOUSE
+        mouse_handler(&event);
+#endif
+#if USE_MOUSEWHEEL
+        mousewheel_handler(&event);
+#endif
+#if USE_KEYBOARD
+        keyboard_handler(&event);
+#endif
+        if(event.type == SDL_QUIT) {
+            if(quit_cb) quit_cb();
+            sdl_clean_up();
+            exit(0);
+        }
+
+        if(event.type == SDL_WINDOWEVENT) {
+            switch(event.window.event) {
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+                case SDL_WINDOWEVENT_TAKE_FOCUS:
+#endif
+                case SDL_WINDOWEVENT_EXPOSED:
+                    present_qry = true;
+                    sdl_monitor_present();
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    /*In case the driver has no `monitor_cb` calling `sdl_monitor_present`*/
+    sdl_monitor_present();
+}
+
+/**
+ * Log the upload statistics of the last period
+ */
+static void sdl_stats_task(lv_task_t * task)
+{
+    (void)task;
+
+    if(stats.presents) {
+        uint32_t full_px = (uint32_t)MONITOR_HOR_RES * MONITOR_VER_RES;
+        printf("SDL monitor: %u presents, %u flushes, %u px/present (%u%% of full frame), "
+               "upload %u us/present, present %u us\n",
+               (unsigned)stats.presents, (unsigned)stats.flushes,
+               (unsigned)(stats.px_uploaded / stats.presents),
+               (unsigned)(stats.px_uploaded * 100 / stats.presents / full_px),
+               (unsigned)(stats.upload_us / stats.presents),
+               (unsigned)(stats.present_us / stats.presents));
+    }
+
+    sdl_monitor_reset_stats();
+}
+
+static void sdl_clean_up(void)
+{
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+}
+
+static uint64_t elapsed_us(Uint64 start)
+{
+    Uint64 ticks = SDL_GetPerformanceCounter() - start;
+    return ticks * 1000000 / SDL_GetPerformanceFrequency();
+}
+
+#endif /* USE_MONITOR && MONITOR_PARTIAL_UPLOAD */
@@ -0,0 +1,61 @@
+/**
+ * @file sdl_monitor.h
+ *
+ */
+
+#ifndef SDL_MONITOR_H
+#define SDL_MONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_drv_conf.h"
+
+#if USE_MONITOR && MONITOR_PARTIAL_UPLOAD
+
+#include "lvgl/lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t flushes;       /*Flushed areas*/
+    uint32_t presents;      /*Presented frames*/
+    uint64_t px_uploaded;   /*Pixels uploaded to the texture*/
+    uint64_t upload_us;     /*Time spent in SDL_UpdateTexture*/
+    uint64_t present_us;    /*Time spent in copying and presenting*/
+} sdl_monitor_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+void sdl_monitor_init(void);
+void sdl_monitor_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p);
+void sdl_monitor_present(void);
+void sdl_monitor_get_stats(sdl_monitor_stats_t * stats);
+void sdl_monitor_reset_stats(void);
+void sdl_monitor_set_quit_cb(void (*quit_cb)(void));
+#if MONITOR_SHADOW
+const lv_color_t * sdl_monitor_get_frame(void);
+void sdl_monitor_show_frame(const lv_color_t * frame);
+#endif
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /* USE_MONITOR && MONITOR_PARTIAL_UPLOAD */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SDL_MONITOR_H */
@@ -0,0 +1,297 @@
+// ------------------------------------------------------------------------
+// Soak benchmark: weeks of heap churn in accelerated time
+// ------------------------------------------------------------------------
+//
+// One iteration is one simulated second of the watch: the clock is
+// updated (and the date at midnight), now and then the battery or the
+// step counter, apps are opened and closed after a while, tiles are
+// swiped, and the countdown, stopwatch and metronome are started and
+// stopped. The pseudo random script is the same on every run. LVGL's tick
+// advances by SOAK_TICK_MS per iteration, so its tasks, animations and
+// refreshes run as well, just faster than the simulated time.
+//
+// The run is split into SOAK_WINDOWS windows. At the end of each, the heap
+// is sampled by mem_telemetry and SOAK_PROBE_ALLOCS allocations of typical
+// sizes are timed together. The first window is warm-up (caches filling,
+// apps created the first time); the average of the first quarter of the
+// rest is compared with the last quarter to detect a trend. Most of the
+// run goes to the console log of the UI, redirect it for long runs.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "my_watch.h"
+#include "tlsf_mem.h"
+#include "mem_telemetry.h"
+#include "soak_bench.h"
+
+typedef struct
+{
+    uint32_t free_biggest;
+    uint8_t frag_pct;
+    uint32_t alloc_ns;    // average of the probe
+    uint32_t failed;      // probe allocations
+    uint32_t step_us_max; // slowest iteration
+} window_t;
+
+typedef struct
+{
+    uint16_t hour, min, sec;
+    uint16_t year, month, day, weekday;
+} sim_time_t;
+
+static window_t windows[SOAK_WINDOWS];
+static uint32_t seed;
+
+// script state
+static sim_time_t now;
+static uint32_t app_until; // iteration to close the open app, 0: none
+static uint32_t steps;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static uint32_t next_rand(void)
+{
+    seed = seed * 1103515245U + 12345U;
+    return (seed >> 16) & 0x7FFF;
+}
+
+// true once in n on average
+static bool chance(uint32_t n)
+{
+    return (next_rand() % n) == 0;
+}
+
+// return true at midnight
+static bool tick(sim_time_t *t)
+{
+    if (++t->sec < 60)
+        return false;
+    t->sec = 0;
+    if (++t->min < 60)
+        return false;
+    t->min = 0;
+    if (++t->hour < 24)
+        return false;
+    t->hour = 0;
+
+    t->weekday = (t->weekday + 1) % 7;
+    if (++t->day > 28) // simplified
+    {
+        t->day = 1;
+        if (++t->month > 12)
+        {
+            t->month = 1;
+            t->year++;
+        }
+    }
+    return true;
+}
+
+// average time of one allocation of a typical size (label texts to objects)
+static void probe(window_t *w)
+{
+    static void *ptrs[SOAK_PROBE_ALLOCS];
+
+    uint32_t start = get_time_us();
+    for (uint16_t i = 0; i < SOAK_PROBE_ALLOCS; i++)
+    {
+        ptrs[i] = lv_mem_alloc(8 + (next_rand() % 57));
+        if (!ptrs[i])
+            w->failed++;
+    }
+    w->alloc_ns = (get_time_us() - start) * 1000 / SOAK_PROBE_ALLOCS;
+
+    for (uint16_t i = 0; i < SOAK_PROBE_ALLOCS; i++)
+        lv_mem_free(ptrs[i]);
+}
+
+// ------------------------------------------------------------------------
+// Scripts
+// ------------------------------------------------------------------------
+
+static void step_gui(uint32_t i)
+{
+    if (tick(&now))
+        updateDate(now.year, now.month, now.day, now.weekday);
+    updateTime(now.hour, now.min, now.sec);
+
+    if (!(i % 30))
+        updateBatteryLevel();
+    if (chance(10))
+        updateStepCounter(steps += next_rand() % 20);
+
+    if (app_until)
+    {
+        if (i >= app_until)
+        {
+            showHome();
+            app_until = 0;
+        }
+    }
+    else if (chance(120))
+    {
+        showApp(1 + (next_rand() % 5)); // corners and the default app
+        app_until = i + 5 + (next_rand() % 25);
+    }
+}
+
+static void step_watch(uint32_t i)
+{
+    tick(&now);
+    my_watch_tick_sec();
+
+    if (chance(20))
+    {
+        int16_t dir = (next_rand() & 1) ? 1 : -1;
+        if (!my_watch_swipe(dir))
+            my_watch_swipe(-dir); // at the end
+    }
+
+    // timers: their labels and rollers are updated while running
+    if (chance(200))
+        my_watch_toggle_timer((my_watch_timer_t)(next_rand() % 3));
+
+    if (app_until)
+    {
+        if (i >= app_until)
+        {
+            my_watch_close_app();
+            app_until = 0;
+        }
+    }
+    else if (chance(300))
+    {
+        my_watch_open_app();
+        app_until = i + 10 + (next_rand() % 50);
+    }
+}
+
+// ------------------------------------------------------------------------
+// Trend
+// ------------------------------------------------------------------------
+
+static void average(uint16_t first, uint16_t n, window_t *avg)
+{
+    uint32_t biggest = 0, frag = 0, ns = 0;
+    for (uint16_t i = first; i < first + n; i++)
+    {
+        biggest += windows[i].free_biggest;
+        frag    += windows[i].frag_pct;
+        ns      += windows[i].alloc_ns;
+    }
+    avg->free_biggest = biggest / n;
+    avg->frag_pct     = (uint8_t)(frag / n);
+    avg->alloc_ns     = ns / n;
+}
+
+static bool check_trend(const char *name)
+{
+    uint16_t quarter = (SOAK_WINDOWS - 1) / 4; // after the warm-up window
+    window_t first, last;
+    average(1, quarter, &first);
+    average(SOAK_WINDOWS - quarter, quarter, &last);
+
+    uint32_t failed = 0, step_us_max = 0;
+    for (uint16_t i = 0; i < SOAK_WINDOWS; i++)
+    {
+        failed += windows[i].failed;
+        step_us_max = LV_MATH_MAX(step_us_max, windows[i].step_us_max);
+    }
+
+    bool ok = true;
+    if (last.free_biggest * 100 < first.free_biggest * (100 - SOAK_MAX_BIGGEST_LOSS))
+    {
+        MY_LOG("Soak %s: largest free block %d -> %d bytes", name, first.free_biggest, last.free_biggest);
+        ok = false;
+    }
+    if (last.frag_pct > first.frag_pct + SOAK_MAX_FRAG_RISE)
+    {
+        MY_LOG("Soak %s: fragmentation %d%% -> %d%%", name, first.frag_pct, last.frag_pct);
+        ok = false;
+    }
+    if (last.alloc_ns * 100 > LV_MATH_MAX(first.alloc_ns, 100) * (100 + SOAK_MAX_LATENCY_RISE)) // us resolution
+    {
+        MY_LOG("Soak %s: allocation %d -> %d ns", name, first.alloc_ns, last.alloc_ns);
+        ok = false;
+    }
+    if (failed)
+    {
+        MY_LOG("Soak %s: %d probe allocations failed", name, failed);
+        ok = false;
+    }
+
+    MY_LOG("Soak %s %s: largest block %d -> %d bytes (min %d), fragmentation %d%% -> %d%%, allocation %d -> %d ns, slowest second %d us",
+        name, ok ? "PASSED" : "FAILED",
+        first.free_biggest, last.free_biggest, mem_telemetry_get_min_biggest(), first.frag_pct, last.frag_pct,
+        first.alloc_ns, last.alloc_ns, step_us_max);
+    return ok;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+bool soak_bench_run(soak_ui_t ui, uint32_t iterations)
+{
+    const char *name = (ui == SOAK_UI_GUI) ? "setupGui" : "my_watch";
+    uint32_t per_window = LV_MATH_MAX(iterations / SOAK_WINDOWS, 1);
+
+    seed = 1;
+    now.hour = 23; now.min = 50; now.sec = 0; // midnight soon
+    now.year = 2020; now.month = 9; now.day = 22; now.weekday = 2;
+    app_until = 0;
+    steps = 0;
+    memset(windows, 0, sizeof(windows));
+
+    lv_scr_load(lv_obj_create(NULL, NULL));
+    if (ui == SOAK_UI_GUI)
+    {
+        setupGui();
+        updateDate(now.year, now.month, now.day, now.weekday);
+    }
+    else
+        my_watch();
+
+    MY_LOG("Soak %s: %d simulated seconds", name, per_window * SOAK_WINDOWS);
+    uint32_t start = get_time_us();
+    for (uint16_t w = 0; w < SOAK_WINDOWS; w++)
+    {
+        window_t *win = &windows[w];
+        for (uint32_t i = w * per_window; i < (w + 1) * per_window; i++)
+        {
+            uint32_t step_start = get_time_us();
+            if (ui == SOAK_UI_GUI)
+                step_gui(i);
+            else
+                step_watch(i);
+            lv_tick_inc(SOAK_TICK_MS);
+            lv_task_handler();
+            win->step_us_max = LV_MATH_MAX(win->step_us_max, get_time_us() - step_start);
+        }
+
+        const mem_sample_t *s = mem_telemetry_sample();
+        win->free_biggest = s->free_biggest;
+        win->frag_pct = s->frag_pct;
+        probe(win);
+
+        if (!(w % 8) || (w == SOAK_WINDOWS - 1))
+            MY_LOG("Soak %s %2d/%d: largest block %d bytes, fragmentation %d%%, allocation %d ns, slowest second %d us",
+                name, w + 1, SOAK_WINDOWS, win->free_biggest, win->frag_pct, win->alloc_ns, win->step_us_max);
+    }
+    MY_LOG("Soak %s: %d s", name, (get_time_us() - start) / 1000000);
+
+    mem_telemetry_report();
+    return check_trend(name);
+}
+
+bool soak_bench(void)
+{
+    bool ok = soak_bench_run(SOAK_UI_GUI, SOAK_ITERATIONS);
+    ok = soak_bench_run(SOAK_UI_WATCH, SOAK_ITERATIONS) && ok; // on top of the first
+    MY_LOG("Soak benchmark %s", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// ------------------------------------------------------------------------
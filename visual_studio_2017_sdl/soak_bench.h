@@ -0,0 +1,44 @@
+// ------------------------------------------------------------------------
+// Soak benchmark: weeks of heap churn in accelerated time
+// ------------------------------------------------------------------------
+
+#ifndef __SOAK_BENCH_H__
+#define __SOAK_BENCH_H__
+
+#define SOAK_ITERATIONS       1000000 // simulated seconds per UI (11.5 days)
+#define SOAK_WINDOWS          64      // samples of the heap over the run
+#define SOAK_PROBE_ALLOCS     128     // timed allocations per sample
+#define SOAK_TICK_MS          1       // per simulated second: tasks, animations
+                                      // and refreshes run accelerated
+
+// limits of the trend: last quarter of the run vs. first quarter
+#define SOAK_MAX_BIGGEST_LOSS 10 // %, largest free block
+#define SOAK_MAX_FRAG_RISE    10 // percentage points of fragmentation
+#define SOAK_MAX_LATENCY_RISE 50 // %, average allocation time
+
+typedef enum
+{
+    SOAK_UI_GUI,   // setupGui(): watch face with apps in the corners
+    SOAK_UI_WATCH  // my_watch(): tileview
+} soak_ui_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sets up the UI on a new screen and drives it by a scripted mix of clock
+// updates (with midnight), battery and step updates, apps opened and
+// closed, and tile swipes. Logs the heap over the run and returns false
+// if it gets worse than the limits above. The UI stays set up.
+bool soak_bench_run(soak_ui_t ui, uint32_t iterations);
+
+// both UIs, instead of the watch in main(); true if both passed
+bool soak_bench(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __SOAK_BENCH_H__
+
+// ------------------------------------------------------------------------
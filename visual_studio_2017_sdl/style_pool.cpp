@@ -0,0 +1,241 @@
+// ------------------------------------------------------------------------
+// Shared styles: identical property sets map to one interned lv_style_t
+// ------------------------------------------------------------------------
+//
+// Each lv_obj_set_style_local_...() allocates a local style for the object
+// (the lv_style_t and its property map), although most containers just
+// get the same border side or font. Here a property set is interned once
+// and its lv_style_t is added to all objects using it: one property map
+// for all of them, which also stays in the cache while styles are looked
+// up. Shared styles live as long as the program and are never modified.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "style_pool.h"
+#include "app_arena.h"
+
+typedef struct
+{
+    lv_style_t style;
+    uint8_t num;
+    style_prop_t props[STYLE_POOL_MAX_PROPS];  // sorted by prop
+} entry_t;
+
+static entry_t pool[STYLE_POOL_MAX_STYLES];
+static uint16_t num_styles;
+
+// parts to look for style lists: main, virtual and real parts of the widgets
+#define PART_RANGE_LEN 16
+static const uint8_t part_ranges[] = { 0x00, 0x40 };
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static void sort_props(style_prop_t *props, uint8_t num)
+{
+    for (uint8_t i = 1; i < num; i++)
+    {
+        style_prop_t p = props[i];
+        uint8_t j = i;
+        for (; (j > 0) && (props[j - 1].prop > p.prop); j--)
+            props[j] = props[j - 1];
+        props[j] = p;
+    }
+}
+
+// field by field, style_prop_t has padding
+static bool same_props(const style_prop_t *a, const style_prop_t *b, uint8_t num)
+{
+    for (uint8_t i = 0; i < num; i++)
+    {
+        if ((a[i].prop != b[i].prop) || (a[i].value != b[i].value))
+            return false;
+    }
+    return true;
+}
+
+static void set_prop(lv_style_t *style, const style_prop_t *p)
+{
+    uint8_t id = p->prop & 0xF;
+    if (id < LV_STYLE_ID_COLOR)
+        _lv_style_set_int(style, p->prop, (lv_style_int_t)(intptr_t)p->value);
+    else if (id < LV_STYLE_ID_OPA)
+    {
+        lv_color_t color;
+        color.full = p->value;
+        _lv_style_set_color(style, p->prop, color);
+    }
+    else if (id < LV_STYLE_ID_PTR)
+        _lv_style_set_opa(style, p->prop, (lv_opa_t)p->value);
+    else
+        _lv_style_set_ptr(style, p->prop, (const void *)p->value);
+}
+
+static void set_local_prop(lv_obj_t *obj, uint8_t part, const style_prop_t *p)
+{
+    uint8_t id = p->prop & 0xF;
+    if (id < LV_STYLE_ID_COLOR)
+        _lv_obj_set_style_local_int(obj, part, p->prop, (lv_style_int_t)(intptr_t)p->value);
+    else if (id < LV_STYLE_ID_OPA)
+    {
+        lv_color_t color;
+        color.full = p->value;
+        _lv_obj_set_style_local_color(obj, part, p->prop, color);
+    }
+    else if (id < LV_STYLE_ID_PTR)
+        _lv_obj_set_style_local_opa(obj, part, p->prop, (lv_opa_t)p->value);
+    else
+        _lv_obj_set_style_local_ptr(obj, part, p->prop, (const void *)p->value);
+}
+
+static entry_t *find_entry(const lv_style_t *style)
+{
+    if (!num_styles || (style < &pool[0].style) || (style > &pool[num_styles - 1].style))
+        return NULL;
+    return (entry_t *)style; // style is the first member
+}
+
+typedef struct
+{
+    uint16_t objs;
+    uint16_t lists;
+    uint16_t locals;
+    uint16_t shared;    // references to pool styles
+    uint16_t others;    // references to other styles (theme, app)
+    uint32_t list_bytes;
+    uint32_t local_bytes;
+} usage_t;
+
+static void collect(const lv_obj_t *obj, usage_t *u)
+{
+    u->objs++;
+
+    // a widget may return the same list for several parts
+    const lv_style_list_t *seen[2 * PART_RANGE_LEN];
+    uint8_t num_seen = 0;
+
+    for (uint8_t r = 0; r < sizeof(part_ranges); r++)
+    {
+        for (uint8_t part = part_ranges[r]; part < part_ranges[r] + PART_RANGE_LEN; part++)
+        {
+            lv_style_list_t *list = lv_obj_get_style_list(obj, part);
+            if (!list || !list->style_cnt)
+                continue;
+
+            bool dup = false;
+            for (uint8_t i = 0; i < num_seen; i++)
+                dup |= (seen[i] == list);
+            if (dup)
+                continue;
+            seen[num_seen++] = list;
+
+            u->lists++;
+            u->list_bytes += list->style_cnt * sizeof(lv_style_t *);
+
+            lv_style_t *local = lv_style_list_get_local_style(list);
+            if (local)
+            {
+                u->locals++;
+                u->local_bytes += sizeof(lv_style_t) + _lv_style_get_mem_size(local);
+            }
+
+            for (uint8_t i = 0; i < list->style_cnt; i++)
+            {
+                if (list->style_list[i] == local)
+                    continue;
+                if (find_entry(list->style_list[i]))
+                    u->shared++;
+                else
+                    u->others++;
+            }
+        }
+    }
+
+    for (lv_obj_t *child = lv_obj_get_child(obj, NULL); child; child = lv_obj_get_child(obj, child))
+        collect(child, u);
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+lv_style_t *style_pool_get(const style_prop_t *props, uint8_t num)
+{
+    if (num > STYLE_POOL_MAX_PROPS)
+        return NULL;
+
+    style_prop_t key[STYLE_POOL_MAX_PROPS];
+    memcpy(key, props, num * sizeof(style_prop_t));
+    sort_props(key, num);
+
+    for (uint16_t i = 0; i < num_styles; i++)
+    {
+        if ((pool[i].num == num) && same_props(pool[i].props, key, num))
+            return &pool[i].style;
+    }
+
+    if (num_styles >= STYLE_POOL_MAX_STYLES)
+    {
+        MY_LOG("Style pool: full");
+        return NULL;
+    }
+
+    entry_t *e = &pool[num_styles++];
+    lv_style_init(&e->style);
+    e->num = num;
+    memcpy(e->props, key, sizeof(key));
+    app_arena_begin(NULL); // outlives the screen
+    for (uint8_t i = 0; i < num; i++)
+        set_prop(&e->style, &key[i]);
+    app_arena_end();
+    return &e->style;
+}
+
+void style_pool_add(lv_obj_t *obj, uint8_t part, const style_prop_t *props, uint8_t num)
+{
+    lv_style_t *style = style_pool_get(props, num);
+    if (!style)
+    {
+        for (uint8_t i = 0; i < num; i++)
+            set_local_prop(obj, part, &props[i]);
+        return;
+    }
+
+    lv_obj_add_style(obj, part, style);
+}
+
+void style_pool_add_int(lv_obj_t *obj, uint8_t part, lv_state_t state, lv_style_property_t prop, lv_style_int_t value)
+{
+    style_prop_t p = STYLE_PROP_INT(STYLE_PROP_STATE(prop, state), value);
+    style_pool_add(obj, part, &p, 1);
+}
+
+void style_pool_add_color(lv_obj_t *obj, uint8_t part, lv_state_t state, lv_style_property_t prop, lv_color_t color)
+{
+    style_prop_t p = STYLE_PROP_COLOR(STYLE_PROP_STATE(prop, state), color);
+    style_pool_add(obj, part, &p, 1);
+}
+
+void style_pool_add_ptr(lv_obj_t *obj, uint8_t part, lv_state_t state, lv_style_property_t prop, const void *ptr)
+{
+    style_prop_t p = STYLE_PROP_PTR(STYLE_PROP_STATE(prop, state), ptr);
+    style_pool_add(obj, part, &p, 1);
+}
+
+void style_pool_report(const lv_obj_t *scr)
+{
+    usage_t u;
+    memset(&u, 0, sizeof(u));
+    collect(scr, &u);
+
+    MY_LOG("Styles of screen: %d objects, %d style lists (%d bytes), %d local styles (%d bytes), %d shared and %d other styles added",
+        u.objs, u.lists, u.list_bytes, u.locals, u.local_bytes, u.shared, u.others);
+
+    uint32_t bytes = 0;
+    for (uint16_t i = 0; i < num_styles; i++)
+        bytes += _lv_style_get_mem_size(&pool[i].style);
+    MY_LOG("Style pool: %d shared styles (%d bytes)", num_styles, bytes);
+}
+
+// ------------------------------------------------------------------------
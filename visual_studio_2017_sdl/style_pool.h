@@ -0,0 +1,56 @@
+// ------------------------------------------------------------------------
+// Shared styles: identical property sets map to one interned lv_style_t
+// ------------------------------------------------------------------------
+
+#ifndef __STYLE_POOL_H__
+#define __STYLE_POOL_H__
+
+#define STYLE_POOL_MAX_STYLES 16
+#define STYLE_POOL_MAX_PROPS  4 // per style
+
+// 1: log the styles of a screen when it is shown (walks the screen)
+#ifndef STYLE_POOL_REPORT
+#define STYLE_POOL_REPORT 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    lv_style_property_t prop;  // with the state, see STYLE_PROP_STATE()
+    uintptr_t value;           // lv_style_int_t, lv_color_t.full, lv_opa_t or pointer
+} style_prop_t;
+
+#define STYLE_PROP_STATE(prop, state) ((lv_style_property_t)((prop) | ((state) << LV_STYLE_STATE_POS)))
+
+#define STYLE_PROP_INT(prop, value)   { (prop), (uintptr_t)(intptr_t)(lv_style_int_t)(value) }
+#define STYLE_PROP_COLOR(prop, color) { (prop), (uintptr_t)(color).full }
+#define STYLE_PROP_OPA(prop, opa)     { (prop), (uintptr_t)(lv_opa_t)(opa) }
+#define STYLE_PROP_PTR(prop, ptr)     { (prop), (uintptr_t)(ptr) }
+
+// Return the shared style with exactly these properties (in any order),
+// created on first use. The style must not be modified. NULL if the pool is full.
+lv_style_t *style_pool_get(const style_prop_t *props, uint8_t num);
+
+// Instead of lv_obj_set_style_local_...(obj, part, state, value): add the
+// shared style with the single property. Falls back to a local style if the
+// pool is full. Shared styles are added on top of the theme styles, but below
+// the local style of the object.
+void style_pool_add(lv_obj_t *obj, uint8_t part, const style_prop_t *props, uint8_t num);
+void style_pool_add_int(lv_obj_t *obj, uint8_t part, lv_state_t state, lv_style_property_t prop, lv_style_int_t value);
+void style_pool_add_color(lv_obj_t *obj, uint8_t part, lv_state_t state, lv_style_property_t prop, lv_color_t color);
+void style_pool_add_ptr(lv_obj_t *obj, uint8_t part, lv_state_t state, lv_style_property_t prop, const void *ptr);
+
+// log the style memory of the objects of a screen (local, shared, style lists),
+// on demand or by STYLE_POOL_REPORT
+void style_pool_report(const lv_obj_t *scr);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __STYLE_POOL_H__
+
+// ------------------------------------------------------------------------
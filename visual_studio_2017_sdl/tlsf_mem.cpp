@@ -0,0 +1,852 @@
+// ------------------------------------------------------------------------
+// TLSF heap: two-level segregated fit allocator with O(1) alloc and free
+// ------------------------------------------------------------------------
+//
+// The built-in lv_mem heap walks all blocks for a fitting free one (first
+// fit) and joins free neighbours by walking again, so its time grows with
+// the number of blocks, i.e. with the fragmentation from label text reallocs
+// and screens being created and deleted. TLSF keeps a free list per size
+// class: a first level per power of two, split into 16 second level ranges.
+// Two bitmaps tell which lists are not empty, so finding a block big enough
+// takes two bit scans, and a freed block is joined with its free physical
+// neighbours through its header. Both are bounded, whatever the heap holds.
+// Like the built-in heap, the control structure and all blocks live in one
+// fixed pool, so the memory budget is unchanged.
+//
+// A block is a header (size and flags) followed by the payload. The pointer
+// to the previous block lies in the last word of the previous payload and
+// is only valid while that block is free, so a used block costs one word.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "tlsf_mem.h"
+#include "app_arena.h"
+#include "mem_profile.h"
+
+#include <stdlib.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define ALIGN_SIZE_LOG2     3
+#else
+#define ALIGN_SIZE_LOG2     2
+#endif
+#define ALIGN_SIZE          (1 << ALIGN_SIZE_LOG2)
+
+#define SL_INDEX_COUNT_LOG2 4   // 16 second level lists
+#define SL_INDEX_COUNT      (1 << SL_INDEX_COUNT_LOG2)
+#define FL_INDEX_MAX        20  // log2 of TLSF_MAX_POOL
+#define FL_INDEX_SHIFT      (SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define FL_INDEX_COUNT      (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE    (1 << FL_INDEX_SHIFT) // all in first level 0
+
+typedef struct block_s
+{
+    struct block_s *prev_phys; // only valid if the previous block is free
+    size_t size;               // of the payload, bit 0: free, bit 1: previous free
+    struct block_s *next_free; // only valid if free
+    struct block_s *prev_free;
+} block_t;
+
+#define BLOCK_FREE      ((size_t)1)
+#define BLOCK_PREV_FREE ((size_t)2)
+#define BLOCK_OVERHEAD  sizeof(size_t) // of a used block
+#define BLOCK_START     (offsetof(block_t, size) + sizeof(size_t)) // of the payload
+#define BLOCK_SIZE_MIN  (sizeof(block_t) - sizeof(block_t *))
+#define BLOCK_SIZE_MAX  ((size_t)1 << FL_INDEX_MAX)
+
+struct tlsf_s
+{
+    block_t null_block; // end of all free lists
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[FL_INDEX_COUNT];
+    block_t *blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+    block_t *first;
+    uint32_t total_size;
+    uint32_t used_size; // payload of the used blocks
+    uint32_t max_used;
+};
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+// index of the highest / lowest bit set, -1 if none
+static int tlsf_fls(uint32_t word)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    return _BitScanReverse(&index, word) ? (int)index : -1;
+#elif defined(__GNUC__)
+    return word ? 31 - __builtin_clz(word) : -1;
+#else
+    int bit = 31;
+    if (!word)
+        return -1;
+    if (!(word & 0xFFFF0000u)) { word <<= 16; bit -= 16; }
+    if (!(word & 0xFF000000u)) { word <<= 8; bit -= 8; }
+    if (!(word & 0xF0000000u)) { word <<= 4; bit -= 4; }
+    if (!(word & 0xC0000000u)) { word <<= 2; bit -= 2; }
+    if (!(word & 0x80000000u)) { bit -= 1; }
+    return bit;
+#endif
+}
+
+static int tlsf_ffs(uint32_t word)
+{
+    return tlsf_fls(word & (~word + 1)); // lowest bit only
+}
+
+static size_t block_size(const block_t *block)
+{
+    return block->size & ~(BLOCK_FREE | BLOCK_PREV_FREE);
+}
+
+static void block_set_size(block_t *block, size_t size)
+{
+    block->size = size | (block->size & (BLOCK_FREE | BLOCK_PREV_FREE));
+}
+
+static bool block_is_last(const block_t *block)
+{
+    return block_size(block) == 0;
+}
+
+static bool block_is_free(const block_t *block)
+{
+    return (block->size & BLOCK_FREE) != 0;
+}
+
+static bool block_is_prev_free(const block_t *block)
+{
+    return (block->size & BLOCK_PREV_FREE) != 0;
+}
+
+static void block_set_prev_free(block_t *block, bool free)
+{
+    block->size = free ? (block->size | BLOCK_PREV_FREE) : (block->size & ~BLOCK_PREV_FREE);
+}
+
+static block_t *block_from_ptr(const void *ptr)
+{
+    return (block_t *)((uint8_t *)ptr - BLOCK_START);
+}
+
+static void *block_to_ptr(const block_t *block)
+{
+    return (uint8_t *)block + BLOCK_START;
+}
+
+static block_t *offset_to_block(const void *ptr, ptrdiff_t ofs)
+{
+    return (block_t *)((uint8_t *)ptr + ofs);
+}
+
+static block_t *block_next(const block_t *block)
+{
+    return offset_to_block(block_to_ptr(block), block_size(block) - BLOCK_OVERHEAD);
+}
+
+static block_t *block_link_next(block_t *block)
+{
+    block_t *next = block_next(block);
+    next->prev_phys = block;
+    return next;
+}
+
+static void block_mark_as_free(block_t *block)
+{
+    block_t *next = block_link_next(block);
+    block_set_prev_free(next, true);
+    block->size |= BLOCK_FREE;
+}
+
+static void block_mark_as_used(block_t *block)
+{
+    block_set_prev_free(block_next(block), false);
+    block->size &= ~BLOCK_FREE;
+}
+
+static size_t align_up(size_t x, size_t align)
+{
+    return (x + (align - 1)) & ~(align - 1);
+}
+
+// payload size of the block for a request, 0 if the request can't be met
+static size_t adjust_request_size(size_t size)
+{
+    if (!size || (size >= BLOCK_SIZE_MAX))
+        return 0;
+    size_t aligned = align_up(size, ALIGN_SIZE);
+    return (aligned < BLOCK_SIZE_MIN) ? BLOCK_SIZE_MIN : aligned;
+}
+
+// list of a block size
+static void mapping_insert(size_t size, int *fl, int *sl)
+{
+    if (size < SMALL_BLOCK_SIZE)
+    {
+        *fl = 0;
+        *sl = (int)size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+    }
+    else
+    {
+        int bit = tlsf_fls((uint32_t)size);
+        *sl = (int)(size >> (bit - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        *fl = bit - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+// first list whose blocks are all big enough for size
+static void mapping_search(size_t size, int *fl, int *sl)
+{
+    if (size >= SMALL_BLOCK_SIZE)
+        size += ((size_t)1 << (tlsf_fls((uint32_t)size) - SL_INDEX_COUNT_LOG2)) - 1;
+    mapping_insert(size, fl, sl);
+}
+
+static block_t *search_suitable_block(tlsf_t tlsf, int *fl, int *sl)
+{
+    uint32_t sl_map = tlsf->sl_bitmap[*fl] & (~0u << *sl);
+    if (!sl_map)
+    {
+        // next bigger first level
+        uint32_t fl_map = tlsf->fl_bitmap & (~0u << (*fl + 1));
+        if (!fl_map)
+            return NULL;
+        *fl = tlsf_ffs(fl_map);
+        sl_map = tlsf->sl_bitmap[*fl];
+    }
+    *sl = tlsf_ffs(sl_map);
+    return tlsf->blocks[*fl][*sl];
+}
+
+static void remove_free_block(tlsf_t tlsf, block_t *block, int fl, int sl)
+{
+    block_t *prev = block->prev_free;
+    block_t *next = block->next_free;
+    next->prev_free = prev;
+    prev->next_free = next;
+
+    if (tlsf->blocks[fl][sl] == block)
+    {
+        tlsf->blocks[fl][sl] = next;
+        if (next == &tlsf->null_block)
+        {
+            tlsf->sl_bitmap[fl] &= ~(1u << sl);
+            if (!tlsf->sl_bitmap[fl])
+                tlsf->fl_bitmap &= ~(1u << fl);
+        }
+    }
+}
+
+static void insert_free_block(tlsf_t tlsf, block_t *block, int fl, int sl)
+{
+    block_t *current = tlsf->blocks[fl][sl];
+    block->next_free = current;
+    block->prev_free = &tlsf->null_block;
+    current->prev_free = block;
+
+    tlsf->blocks[fl][sl] = block;
+    tlsf->fl_bitmap |= 1u << fl;
+    tlsf->sl_bitmap[fl] |= 1u << sl;
+}
+
+static void block_remove(tlsf_t tlsf, block_t *block)
+{
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    remove_free_block(tlsf, block, fl, sl);
+}
+
+static void block_insert(tlsf_t tlsf, block_t *block)
+{
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    insert_free_block(tlsf, block, fl, sl);
+}
+
+static bool block_can_split(const block_t *block, size_t size)
+{
+    return block_size(block) >= sizeof(block_t) + size;
+}
+
+// cut the block to size, returns the free rest (flags of its previous block to be set)
+static block_t *block_split(block_t *block, size_t size)
+{
+    block_t *rest = offset_to_block(block_to_ptr(block), size - BLOCK_OVERHEAD);
+    rest->size = block_size(block) - (size + BLOCK_OVERHEAD);
+    block_set_size(block, size);
+    block_mark_as_free(rest);
+    return rest;
+}
+
+static block_t *block_absorb(block_t *prev, block_t *block)
+{
+    prev->size += block_size(block) + BLOCK_OVERHEAD; // keeps the flags of prev
+    block_link_next(prev);
+    return prev;
+}
+
+static block_t *block_merge_prev(tlsf_t tlsf, block_t *block)
+{
+    if (block_is_prev_free(block))
+    {
+        block_t *prev = block->prev_phys;
+        block_remove(tlsf, prev);
+        block = block_absorb(prev, block);
+    }
+    return block;
+}
+
+static block_t *block_merge_next(tlsf_t tlsf, block_t *block)
+{
+    block_t *next = block_next(block);
+    if (block_is_free(next))
+    {
+        block_remove(tlsf, next);
+        block = block_absorb(block, next);
+    }
+    return block;
+}
+
+// return the end of a free block to the lists
+static void block_trim_free(tlsf_t tlsf, block_t *block, size_t size)
+{
+    if (block_can_split(block, size))
+    {
+        block_t *rest = block_split(block, size);
+        block_link_next(block);
+        block_set_prev_free(rest, true);
+        block_insert(tlsf, rest);
+    }
+}
+
+// return the end of a used block to the lists
+static void block_trim_used(tlsf_t tlsf, block_t *block, size_t size)
+{
+    if (block_can_split(block, size))
+    {
+        block_t *rest = block_split(block, size);
+        block_set_prev_free(rest, false);
+        rest = block_merge_next(tlsf, rest);
+        block_insert(tlsf, rest);
+    }
+}
+
+static block_t *block_locate_free(tlsf_t tlsf, size_t size)
+{
+    int fl, sl;
+    mapping_search(size, &fl, &sl);
+    if (fl >= FL_INDEX_COUNT)
+        return NULL;
+
+    block_t *block = search_suitable_block(tlsf, &fl, &sl);
+    if (block)
+        remove_free_block(tlsf, block, fl, sl);
+    return block;
+}
+
+static void add_used(tlsf_t tlsf, const block_t *block)
+{
+    tlsf->used_size += (uint32_t)block_size(block);
+    if (tlsf->used_size > tlsf->max_used)
+        tlsf->max_used = tlsf->used_size;
+}
+
+// ------------------------------------------------------------------------
+// Heap on a given buffer
+// ------------------------------------------------------------------------
+
+tlsf_t tlsf_create(void *mem, size_t bytes)
+{
+    uint8_t *start = (uint8_t *)align_up((size_t)mem, ALIGN_SIZE);
+    size_t control_size = align_up(sizeof(struct tlsf_s), ALIGN_SIZE);
+    if (bytes < (size_t)(start - (uint8_t *)mem) + control_size + 2 * BLOCK_OVERHEAD + BLOCK_SIZE_MIN)
+        return NULL;
+
+    // pool: one free block and an empty used one marking the end
+    uint8_t *pool = start + control_size;
+    size_t pool_size = (bytes - (size_t)(pool - (uint8_t *)mem) - 2 * BLOCK_OVERHEAD) & ~(size_t)(ALIGN_SIZE - 1);
+    if (pool_size >= BLOCK_SIZE_MAX)
+    {
+        MY_LOG("TLSF: pool of %u bytes too big", (unsigned)bytes);
+        return NULL;
+    }
+
+    tlsf_t tlsf = (tlsf_t)start;
+    memset(tlsf, 0, sizeof(struct tlsf_s));
+    tlsf->null_block.next_free = &tlsf->null_block;
+    tlsf->null_block.prev_free = &tlsf->null_block;
+    for (int fl = 0; fl < FL_INDEX_COUNT; fl++)
+    {
+        for (int sl = 0; sl < SL_INDEX_COUNT; sl++)
+            tlsf->blocks[fl][sl] = &tlsf->null_block;
+    }
+
+    block_t *block = offset_to_block(pool, -(ptrdiff_t)BLOCK_OVERHEAD); // prev_phys in the control area
+    block->size = pool_size | BLOCK_FREE;
+    block_insert(tlsf, block);
+
+    block_t *last = block_link_next(block);
+    last->size = BLOCK_PREV_FREE;
+
+    tlsf->first = block;
+    tlsf->total_size = (uint32_t)pool_size;
+    return tlsf;
+}
+
+void *tlsf_malloc(tlsf_t tlsf, size_t size)
+{
+    size_t adjust = adjust_request_size(size);
+    if (!adjust)
+        return NULL;
+
+    block_t *block = block_locate_free(tlsf, adjust);
+    if (!block)
+        return NULL;
+
+    block_trim_free(tlsf, block, adjust);
+    block_mark_as_used(block);
+    add_used(tlsf, block);
+    return block_to_ptr(block);
+}
+
+void tlsf_free(tlsf_t tlsf, void *ptr)
+{
+    if (!ptr)
+        return;
+
+    block_t *block = block_from_ptr(ptr);
+    if (block_is_free(block))
+    {
+        MY_LOG("TLSF: %p freed twice", ptr);
+        return;
+    }
+
+    tlsf->used_size -= (uint32_t)block_size(block);
+    block_mark_as_free(block);
+    block = block_merge_prev(tlsf, block);
+    block = block_merge_next(tlsf, block);
+    block_insert(tlsf, block);
+}
+
+void *tlsf_realloc(tlsf_t tlsf, void *ptr, size_t size)
+{
+    if (!ptr)
+        return tlsf_malloc(tlsf, size);
+    if (!size)
+    {
+        tlsf_free(tlsf, ptr);
+        return NULL;
+    }
+
+    block_t *block = block_from_ptr(ptr);
+    block_t *next = block_next(block);
+    size_t cur_size = block_size(block);
+    size_t combined = cur_size + block_size(next) + BLOCK_OVERHEAD;
+    size_t adjust = adjust_request_size(size);
+    if (!adjust)
+        return NULL;
+
+    if ((adjust > cur_size) && (!block_is_free(next) || (adjust > combined)))
+    {
+        // move
+        void *p = tlsf_malloc(tlsf, size);
+        if (p)
+        {
+            memcpy(p, ptr, LV_MATH_MIN(cur_size, size));
+            tlsf_free(tlsf, ptr);
+        }
+        return p;
+    }
+
+    // in place: grow into the next block, or return the end
+    tlsf->used_size -= (uint32_t)cur_size;
+    if (adjust > cur_size)
+    {
+        block_merge_next(tlsf, block);
+        block_mark_as_used(block);
+    }
+    block_trim_used(tlsf, block, adjust);
+    add_used(tlsf, block);
+    return ptr;
+}
+
+size_t tlsf_block_size(const void *ptr)
+{
+    return ptr ? block_size(block_from_ptr(ptr)) : 0;
+}
+
+void tlsf_monitor(tlsf_t tlsf, lv_mem_monitor_t *mon)
+{
+    memset(mon, 0, sizeof(lv_mem_monitor_t));
+    mon->total_size = tlsf->total_size;
+
+    for (block_t *block = tlsf->first; !block_is_last(block); block = block_next(block))
+    {
+        uint32_t size = (uint32_t)block_size(block);
+        if (block_is_free(block))
+        {
+            mon->free_cnt++;
+            mon->free_size += size;
+            if (size > mon->free_biggest_size)
+                mon->free_biggest_size = size;
+        }
+        else
+            mon->used_cnt++;
+    }
+
+    mon->used_pct = (uint8_t)(100 - (100U * mon->free_size) / mon->total_size);
+    mon->frag_pct = mon->free_size ? (uint8_t)(100 - (100U * mon->free_biggest_size) / mon->free_size) : 0;
+}
+
+uint32_t tlsf_get_used(tlsf_t tlsf)
+{
+    return tlsf->used_size;
+}
+
+uint32_t tlsf_get_max_used(tlsf_t tlsf)
+{
+    return tlsf->max_used;
+}
+
+bool tlsf_check(tlsf_t tlsf)
+{
+    // physical blocks: flags of the neighbours agree, free ones are joined
+    bool prev_free = false;
+    for (block_t *block = tlsf->first; !block_is_last(block); block = block_next(block))
+    {
+        if (block_is_prev_free(block) != prev_free)
+        {
+            MY_LOG("TLSF: block %p has a wrong previous free flag", block);
+            return false;
+        }
+        if (prev_free && block_is_free(block))
+        {
+            MY_LOG("TLSF: free block %p not joined", block);
+            return false;
+        }
+        prev_free = block_is_free(block);
+    }
+
+    // free lists: blocks of the right size class, bitmaps match
+    for (int fl = 0; fl < FL_INDEX_COUNT; fl++)
+    {
+        for (int sl = 0; sl < SL_INDEX_COUNT; sl++)
+        {
+            block_t *block = tlsf->blocks[fl][sl];
+            bool listed = (block != &tlsf->null_block);
+            if ((((tlsf->sl_bitmap[fl] >> sl) & 1) != listed) || (listed && !((tlsf->fl_bitmap >> fl) & 1)))
+            {
+                MY_LOG("TLSF: bitmap of list %d/%d wrong", fl, sl);
+                return false;
+            }
+            for (; block != &tlsf->null_block; block = block->next_free)
+            {
+                int block_fl, block_sl;
+                mapping_insert(block_size(block), &block_fl, &block_sl);
+                if (!block_is_free(block) || (block_fl != fl) || (block_sl != sl))
+                {
+                    MY_LOG("TLSF: block %p in wrong list %d/%d", block, fl, sl);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------
+// Heap of lv_mem_alloc()
+// ------------------------------------------------------------------------
+
+static uint64_t mem_pool[TLSF_MEM_SIZE / sizeof(uint64_t)]; // aligned
+static tlsf_t mem_heap;
+
+// lv_mem_init() doesn't know custom allocators
+static tlsf_t get_mem_heap(void)
+{
+    if (!mem_heap)
+        mem_heap = tlsf_create(mem_pool, sizeof(mem_pool));
+    return mem_heap;
+}
+
+void *tlsf_mem_alloc(size_t size)
+{
+    void *p = NULL;
+#if USE_APP_ARENA
+    p = app_arena_alloc(size);
+#endif
+    if (!p)
+        p = tlsf_malloc(get_mem_heap(), size);
+#if USE_MEM_PROFILE
+    mem_profile_alloc(p, size);
+#endif
+    return p;
+}
+
+void tlsf_mem_free(void *ptr)
+{
+#if USE_MEM_PROFILE
+    mem_profile_free(ptr);
+#endif
+#if USE_APP_ARENA
+    if (app_arena_free(ptr))
+        return;
+#endif
+    tlsf_free(get_mem_heap(), ptr);
+}
+
+void *tlsf_mem_realloc(void *ptr, size_t size)
+{
+#if USE_APP_ARENA
+    // arena blocks move through alloc and free, which know the arenas
+    if (ptr && app_arena_owns(ptr))
+    {
+        void *p = size ? tlsf_mem_alloc(size) : NULL;
+        if (p || !size)
+        {
+            if (p)
+                memcpy(p, ptr, LV_MATH_MIN(tlsf_block_size(ptr), size));
+            tlsf_mem_free(ptr);
+        }
+        return p;
+    }
+#endif
+    void *p = tlsf_realloc(get_mem_heap(), ptr, size);
+#if USE_MEM_PROFILE
+    mem_profile_realloc(ptr, p, size);
+#endif
+    return p;
+}
+
+void tlsf_mem_monitor(lv_mem_monitor_t *mon)
+{
+    tlsf_monitor(get_mem_heap(), mon);
+}
+
+uint32_t tlsf_mem_get_max_used(void)
+{
+    return tlsf_get_max_used(get_mem_heap());
+}
+
+bool tlsf_mem_check(void)
+{
+    return tlsf_check(get_mem_heap());
+}
+
+// ------------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------------
+//
+// The same pseudo random sequence of requests runs on both heaps:
+//   labels:  reallocs of long-lived label texts (time, date, counters)
+//   screens: a screen's objects, styles and texts are created, some survive
+//            (caches, models), label texts change, then the screen is deleted
+// Each request is timed with get_time_us(), so on the PC most take 0 us;
+// the histogram shows the slow outliers, the average comes from the total.
+
+#define BENCH_LABELS       24
+#define BENCH_LABEL_OPS    2000
+#define BENCH_SCREENS      20
+#define BENCH_SCREEN_OBJS  80
+#define BENCH_KEEP_EVERY   8  // of the screen's allocations
+#define BENCH_HIST_BINS    12 // 0, 1, 2-3, 4-7, ... us
+
+typedef struct
+{
+    const char *name;
+    void *(*alloc)(size_t size);
+    void (*free)(void *ptr);
+    void *(*realloc)(void *ptr, size_t size);
+    void (*monitor)(lv_mem_monitor_t *mon);
+} bench_heap_t;
+
+typedef struct
+{
+    uint32_t ops;
+    uint32_t failed;
+    uint32_t total_us;
+    uint32_t max_us;
+    uint32_t hist[BENCH_HIST_BINS];
+} bench_result_t;
+
+static tlsf_t bench_tlsf;
+static uint32_t bench_seed;
+
+static void *bench_tlsf_alloc(size_t size) { return tlsf_malloc(bench_tlsf, size); }
+static void bench_tlsf_free(void *ptr) { tlsf_free(bench_tlsf, ptr); }
+static void *bench_tlsf_realloc(void *ptr, size_t size) { return tlsf_realloc(bench_tlsf, ptr, size); }
+static void bench_tlsf_monitor(lv_mem_monitor_t *mon) { tlsf_monitor(bench_tlsf, mon); }
+
+static void bench_lv_free(void *ptr) { lv_mem_free(ptr); }
+static void bench_lv_monitor(lv_mem_monitor_t *mon) { mem_monitor(mon); }
+
+// xorshift: the same sequence for both heaps
+static uint32_t bench_rand(uint32_t range)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed % range;
+}
+
+// an object, its ext, a style list or a text
+static size_t bench_obj_size(void)
+{
+    static const uint16_t sizes[][2] = { { 64, 96 }, { 16, 128 }, { 8, 24 }, { 8, 40 } };
+    uint32_t kind = bench_rand(4);
+    return sizes[kind][0] + bench_rand(sizes[kind][1] - sizes[kind][0] + 1);
+}
+
+static void bench_record(bench_result_t *res, uint32_t start, bool ok)
+{
+    uint32_t us = get_time_us() - start;
+    uint8_t bin = 0;
+    while ((us >> bin) && (bin < BENCH_HIST_BINS - 1))
+        bin++;
+
+    res->ops++;
+    res->hist[bin]++;
+    if (us > res->max_us)
+        res->max_us = us;
+    if (!ok)
+        res->failed++;
+}
+
+static void *bench_alloc(const bench_heap_t *heap, bench_result_t *res, size_t size)
+{
+    uint32_t start = get_time_us();
+    void *p = heap->alloc(size);
+    bench_record(res, start, p != NULL);
+    return p;
+}
+
+static void bench_free(const bench_heap_t *heap, bench_result_t *res, void *p)
+{
+    if (!p)
+        return; // allocation failed
+    uint32_t start = get_time_us();
+    heap->free(p);
+    bench_record(res, start, true);
+}
+
+static void bench_realloc(const bench_heap_t *heap, bench_result_t *res, void **p, size_t size)
+{
+    uint32_t start = get_time_us();
+    void *q = heap->realloc(*p, size);
+    bench_record(res, start, q != NULL);
+    if (q)
+        *p = q;
+}
+
+static void bench_labels(const bench_heap_t *heap, bench_result_t *res, void **labels, uint32_t ops)
+{
+    for (uint32_t i = 0; i < ops; i++)
+        bench_realloc(heap, res, &labels[bench_rand(BENCH_LABELS)], 4 + bench_rand(45));
+}
+
+static void bench_log(const bench_heap_t *heap, const char *phase, const bench_result_t *res)
+{
+    // upper bound of the bin holding the 99th percentile
+    uint32_t sum = 0;
+    uint8_t bin = 0;
+    while ((bin < BENCH_HIST_BINS - 1) && ((sum += res->hist[bin]) * 100ULL < res->ops * 99ULL))
+        bin++;
+
+    lv_mem_monitor_t mon;
+    heap->monitor(&mon);
+    MY_LOG("  %-7s %-8s %5d ops, %5d ns avg, 99%% < %4d us, max %4d us, %d failed, frag %2d%%, biggest free %6d",
+        phase, heap->name, res->ops, res->ops ? (uint32_t)(res->total_us * 1000ULL / res->ops) : 0,
+        1 << bin, res->max_us, res->failed, mon.frag_pct, mon.free_biggest_size);
+}
+
+static void bench_run(const bench_heap_t *heap)
+{
+    void *labels[BENCH_LABELS] = { NULL };
+    void *objs[BENCH_SCREEN_OBJS];
+    void *kept[BENCH_SCREENS * BENCH_SCREEN_OBJS / BENCH_KEEP_EVERY] = { NULL };
+    uint16_t num_kept = 0;
+    bench_result_t res;
+
+    bench_seed = 0x2020u;
+
+    // labels
+    memset(&res, 0, sizeof(res));
+    uint32_t start = get_time_us();
+    for (uint8_t i = 0; i < BENCH_LABELS; i++)
+        labels[i] = bench_alloc(heap, &res, 4 + bench_rand(45));
+    bench_labels(heap, &res, labels, BENCH_LABEL_OPS);
+    res.total_us = get_time_us() - start;
+    bench_log(heap, "labels", &res);
+
+    // screens
+    memset(&res, 0, sizeof(res));
+    start = get_time_us();
+    for (uint8_t s = 0; s < BENCH_SCREENS; s++)
+    {
+        for (uint8_t i = 0; i < BENCH_SCREEN_OBJS; i++)
+        {
+            void *p = bench_alloc(heap, &res, bench_obj_size());
+            if ((i % BENCH_KEEP_EVERY) == BENCH_KEEP_EVERY - 1)
+            {
+                kept[num_kept++] = p;
+                objs[i] = NULL;
+            }
+            else
+                objs[i] = p;
+        }
+
+        bench_labels(heap, &res, labels, BENCH_LABEL_OPS / BENCH_SCREENS);
+
+        // delete in random order
+        for (uint8_t i = BENCH_SCREEN_OBJS; i > 0; i--)
+        {
+            uint8_t j = (uint8_t)bench_rand(i);
+            bench_free(heap, &res, objs[j]);
+            objs[j] = objs[i - 1];
+        }
+    }
+    res.total_us = get_time_us() - start;
+    bench_log(heap, "screens", &res);
+
+    for (uint16_t i = 0; i < num_kept; i++)
+        heap->free(kept[i]);
+    for (uint8_t i = 0; i < BENCH_LABELS; i++)
+        heap->free(labels[i]);
+}
+
+void tlsf_mem_bench(void)
+{
+    void *buf = malloc(TLSF_MEM_SIZE); // not in the LVGL heap
+    bench_tlsf = buf ? tlsf_create(buf, TLSF_MEM_SIZE) : NULL;
+    if (!bench_tlsf)
+    {
+        MY_LOG("Mem bench: out of memory");
+        free(buf);
+        return;
+    }
+
+    const bench_heap_t heaps[] = {
+#if LV_MEM_TLSF
+        { "lv_mem", lv_mem_alloc, bench_lv_free, lv_mem_realloc, bench_lv_monitor },
+#else
+        { "built-in", lv_mem_alloc, bench_lv_free, lv_mem_realloc, bench_lv_monitor },
+#endif
+        { "TLSF", bench_tlsf_alloc, bench_tlsf_free, bench_tlsf_realloc, bench_tlsf_monitor },
+    };
+
+    MY_LOG("Mem bench: %d KB heaps, lv_mem_alloc() is %s", TLSF_MEM_SIZE / 1024, LV_MEM_TLSF ? "TLSF" : "built-in");
+    for (uint8_t i = 0; i < sizeof(heaps) / sizeof(heaps[0]); i++)
+        bench_run(&heaps[i]);
+
+    if (!tlsf_check(bench_tlsf))
+        MY_LOG("Mem bench: TLSF heap corrupt");
+    free(buf);
+    bench_tlsf = NULL;
+}
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,75 @@
+// ------------------------------------------------------------------------
+// TLSF heap: two-level segregated fit allocator with O(1) alloc and free
+// ------------------------------------------------------------------------
+
+#ifndef __TLSF_MEM_H__
+#define __TLSF_MEM_H__
+
+// Used by lv_mem_alloc() if LV_MEM_TLSF is set in lv_conf.h, then included
+// by lv_mem.c as LV_MEM_CUSTOM_INCLUDE (after lv_mem.h).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TLSF_MEM_SIZE  LV_MEM_SIZE  // pool of lv_mem_alloc()
+#define TLSF_MAX_POOL  (1UL << 20)  // bytes, limit of the size classes
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ------------------------------------------------------------------------
+// Heap on a given buffer
+
+typedef struct tlsf_s *tlsf_t;
+
+// The control structure (about 1 KB) is placed at the start of mem.
+// Returns NULL if bytes is too small or above TLSF_MAX_POOL.
+tlsf_t tlsf_create(void *mem, size_t bytes);
+
+void *tlsf_malloc(tlsf_t tlsf, size_t size);
+void tlsf_free(tlsf_t tlsf, void *ptr);
+// in place if the block or its free neighbour is big enough
+void *tlsf_realloc(tlsf_t tlsf, void *ptr, size_t size);
+
+size_t tlsf_block_size(const void *ptr);
+
+// as lv_mem_monitor(), walks all blocks
+void tlsf_monitor(tlsf_t tlsf, lv_mem_monitor_t *mon);
+uint32_t tlsf_get_used(tlsf_t tlsf);     // payload bytes of the used blocks
+uint32_t tlsf_get_max_used(tlsf_t tlsf);
+
+// walks all blocks and lists, returns false (and logs) on corruption
+bool tlsf_check(tlsf_t tlsf);
+
+// ------------------------------------------------------------------------
+// Heap of lv_mem_alloc(), TLSF_MEM_SIZE bytes (first the active app arena)
+
+void *tlsf_mem_alloc(size_t size);
+void tlsf_mem_free(void *ptr);
+void *tlsf_mem_realloc(void *ptr, size_t size);
+
+void tlsf_mem_monitor(lv_mem_monitor_t *mon);
+uint32_t tlsf_mem_get_max_used(void);
+bool tlsf_mem_check(void); // the heap, not the app arenas in it
+
+// Log latency and fragmentation of the same simulated watch workload on
+// lv_mem_alloc() and on a TLSF heap of the same size. With LV_MEM_TLSF 0,
+// this compares the built-in heap with TLSF.
+void tlsf_mem_bench(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+// lv_mem_monitor() reports nothing for a custom allocator
+#if LV_MEM_TLSF
+#define mem_monitor(mon) tlsf_mem_monitor(mon)
+#else
+#define mem_monitor(mon) lv_mem_monitor(mon)
+#endif
+
+#endif // __TLSF_MEM_H__
+
+// ------------------------------------------------------------------------
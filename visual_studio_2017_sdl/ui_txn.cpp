@@ -0,0 +1,188 @@
+// ------------------------------------------------------------------------
+// Update transactions: coalesce a burst of widget changes
+// ------------------------------------------------------------------------
+//
+// E.g. a new time sets the text of a label with auto realign: the label is
+// resized (invalidate), realigned (invalidate old and new position) and its
+// container refreshes the layout (move and invalidate the siblings). With
+// several changes in a row, all of this is repeated per setter.
+//
+// Within a transaction, auto realign is switched off and the containers
+// get LV_LAYOUT_OFF / LV_FIT_NONE, so the setters only change and invalidate
+// the objects themselves. The commit restores the settings and applies the
+// realign and layout once per object that changed its size. Finally the
+// invalidated areas covered by another one are removed (LVGL only skips a
+// new area covered by an existing one, not the other way round).
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "ui_txn.h"
+
+#if USE_UI_TXN
+
+typedef struct
+{
+    lv_obj_t *obj;
+    lv_coord_t w, h;         // at begin
+    bool realign;            // auto realign suspended
+    bool cont;               // layout / fit suspended
+    lv_cont_ext_t cont_ext;  // saved layout and fit
+} txn_obj_t;
+
+static txn_obj_t objs[UI_TXN_MAX_OBJ];
+static uint16_t num_objs;
+static uint16_t depth;
+static lv_disp_t *disp;
+static uint16_t inv_start; // first area invalidated within the transaction
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static bool is_cont(const lv_obj_t *obj)
+{
+    lv_obj_type_t type;
+    lv_obj_get_type(obj, &type);
+    return !strcmp(type.type[0], "lv_cont") || !strcmp(type.type[0], "lv_page");
+}
+
+static void suspend_obj(lv_obj_t *obj)
+{
+    if (num_objs >= UI_TXN_MAX_OBJ)
+        return;
+
+    txn_obj_t *o = &objs[num_objs++];
+    o->obj = obj;
+    o->w = lv_obj_get_width(obj);
+    o->h = lv_obj_get_height(obj);
+
+    o->realign = obj->realign.auto_realign;
+    obj->realign.auto_realign = 0;
+
+    o->cont = false;
+    if (is_cont(obj))
+    {
+        lv_cont_ext_t *ext = (lv_cont_ext_t *)lv_obj_get_ext_attr(obj);
+        if ((ext->layout != LV_LAYOUT_OFF) || ext->fit_left || ext->fit_right || ext->fit_top || ext->fit_bottom)
+        {
+            o->cont = true;
+            o->cont_ext = *ext;
+            ext->layout = LV_LAYOUT_OFF;
+            ext->fit_left = ext->fit_right = ext->fit_top = ext->fit_bottom = LV_FIT_NONE;
+        }
+    }
+}
+
+static void suspend_tree(lv_obj_t *obj)
+{
+    suspend_obj(obj);
+
+    lv_obj_t *child = lv_obj_get_child(obj, NULL);
+    while (child)
+    {
+        suspend_tree(child);
+        child = lv_obj_get_child(obj, child);
+    }
+}
+
+static bool size_changed(const txn_obj_t *o)
+{
+    return (lv_obj_get_width(o->obj) != o->w) || (lv_obj_get_height(o->obj) != o->h);
+}
+
+static void drop_covered_areas(void)
+{
+    if (!disp || (disp->inv_p <= inv_start))
+        return; // nothing new (or replaced by a full screen refresh)
+
+    uint16_t num = disp->inv_p;
+    bool covered[LV_INV_BUF_SIZE] = { false };
+    for (uint16_t i = 0; i < num; i++)
+    {
+        for (uint16_t j = 0; j < num; j++)
+        {
+            if ((j == i) || covered[j] || !_lv_area_is_in(&disp->inv_areas[i], &disp->inv_areas[j], 0))
+                continue;
+            // of two equal areas the later one is dropped
+            if ((j < i) || !_lv_area_is_in(&disp->inv_areas[j], &disp->inv_areas[i], 0))
+            {
+                covered[i] = true;
+                break;
+            }
+        }
+    }
+
+    uint16_t dst = 0;
+    for (uint16_t i = 0; i < num; i++)
+    {
+        if (!covered[i])
+            lv_area_copy(&disp->inv_areas[dst++], &disp->inv_areas[i]);
+    }
+    disp->inv_p = dst;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+void ui_txn_begin(lv_obj_t *scope)
+{
+    if (depth++ || !scope)
+        return;
+
+    num_objs = 0;
+    suspend_tree(scope);
+
+    disp = lv_obj_get_disp(scope);
+    inv_start = disp ? disp->inv_p : 0;
+}
+
+void ui_txn_commit(void)
+{
+    if (!depth || --depth)
+        return;
+
+    // realign
+    for (uint16_t i = 0; i < num_objs; i++)
+    {
+        txn_obj_t *o = &objs[i];
+        if (!o->realign)
+            continue;
+
+        o->obj->realign.auto_realign = 1;
+        if (size_changed(o))
+            lv_obj_realign(o->obj);
+    }
+
+    // layout of the containers with a changed child, innermost first
+    for (uint16_t i = num_objs; i-- > 0;)
+    {
+        txn_obj_t *o = &objs[i];
+        if (!o->cont)
+            continue;
+
+        lv_cont_ext_t *ext = (lv_cont_ext_t *)lv_obj_get_ext_attr(o->obj);
+        ext->layout     = o->cont_ext.layout;
+        ext->fit_left   = o->cont_ext.fit_left;
+        ext->fit_right  = o->cont_ext.fit_right;
+        ext->fit_top    = o->cont_ext.fit_top;
+        ext->fit_bottom = o->cont_ext.fit_bottom;
+
+        for (uint16_t k = i + 1; k < num_objs; k++)
+        {
+            if ((lv_obj_get_parent(objs[k].obj) == o->obj) && size_changed(&objs[k]))
+            {
+                lv_signal_send(o->obj, LV_SIGNAL_CHILD_CHG, objs[k].obj);
+                break;
+            }
+        }
+    }
+
+    drop_covered_areas();
+    num_objs = 0;
+    disp = NULL;
+}
+
+#endif // USE_UI_TXN
+
+// ------------------------------------------------------------------------
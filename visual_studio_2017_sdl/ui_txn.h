@@ -0,0 +1,43 @@
+// ------------------------------------------------------------------------
+// Update transactions: coalesce a burst of widget changes
+// ------------------------------------------------------------------------
+
+#ifndef __UI_TXN_H__
+#define __UI_TXN_H__
+
+// 1: defer realign and layout to the commit, deduplicate the invalidated areas
+#ifndef USE_UI_TXN
+#define USE_UI_TXN 1
+#endif
+
+#define UI_TXN_MAX_OBJ 32 // objects of the scope tracked, the rest behave as usual
+
+#if USE_UI_TXN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Start a transaction on the objects below scope (inclusive).
+// Until the commit, auto realign, container layout and fit are suspended.
+// Nested transactions are merged into the outermost one.
+void ui_txn_begin(lv_obj_t *scope);
+
+// Realign the objects which changed their size once, refresh the layout of
+// their containers once and drop invalidated areas covered by others.
+void ui_txn_commit(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#else // compiled out
+
+#define ui_txn_begin(scope)
+#define ui_txn_commit()
+
+#endif // USE_UI_TXN
+
+#endif // __UI_TXN_H__
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,256 @@
+// ------------------------------------------------------------------------
+// Virtual list: a few row buttons rebound to the model while scrolling
+// ------------------------------------------------------------------------
+//
+// An lv_list creates a button, an image and a label for every entry (about
+// 300 bytes with their styles and texts), so a scan with hundreds of WiFi
+// networks would not fit into the heap of the watch. Here the list is a page
+// whose scrollable is as high as all entries, but holds just enough row
+// buttons to fill the page and one more. Row i is kept in slot i % rows;
+// when the scrollable moves, only the slots whose entry changed are filled
+// again by the row callback and moved to their entry's position.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "vlist.h"
+
+#define NO_INDEX 0xFFFF
+
+typedef struct
+{
+    lv_page_ext_t page; // ext. of ancestor
+    vlist_row_cb_t row_cb;
+    uint16_t count;
+    lv_coord_t row_h;
+    uint8_t num_rows;
+    lv_obj_t *rows[VLIST_MAX_ROWS];
+    uint16_t index[VLIST_MAX_ROWS]; // entry shown in the slot, NO_INDEX: none
+} vlist_ext_t;
+
+static lv_signal_cb_t ancestor_signal;
+static lv_signal_cb_t ancestor_scrl_signal;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+static void row_cb(lv_obj_t *row, lv_event_t event)
+{
+    if (event != LV_EVENT_CLICKED)
+        return;
+
+    lv_obj_t *list = lv_obj_get_parent(lv_obj_get_parent(row));
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+    for (uint8_t i = 0; i < ext->num_rows; i++)
+    {
+        if ((ext->rows[i] == row) && (ext->index[i] != NO_INDEX))
+        {
+            uint32_t index = ext->index[i];
+            lv_event_send(list, LV_EVENT_VALUE_CHANGED, &index);
+            return;
+        }
+    }
+}
+
+// as lv_list_add_btn(), but placed by refr_rows()
+static lv_obj_t *create_row(lv_obj_t *list)
+{
+    lv_obj_t *scrl = lv_page_get_scrollable(list);
+    lv_obj_t *row = lv_btn_create(scrl, NULL);
+    lv_theme_apply(row, LV_THEME_LIST_BTN);
+    lv_btn_set_layout(row, LV_LAYOUT_ROW_MID);
+    lv_btn_set_fit2(row, LV_FIT_NONE, LV_FIT_TIGHT);
+    lv_obj_set_width(row, lv_obj_get_width_fit(scrl));
+    lv_page_glue_obj(row, true);
+    lv_obj_set_event_cb(row, row_cb);
+
+    lv_obj_t *img = lv_img_create(row, NULL);
+    lv_img_set_src(img, LV_SYMBOL_DUMMY);
+    lv_obj_set_click(img, false);
+
+    lv_obj_t *label = lv_label_create(row, NULL);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_DOT);
+    lv_label_set_text(label, "");
+    lv_obj_set_click(label, false);
+    lv_obj_set_width(label, lv_obj_get_width_fit(row) - lv_obj_get_width(img)
+        - lv_obj_get_style_pad_inner(row, LV_BTN_PART_MAIN));
+
+    lv_obj_set_hidden(row, true);
+    return row;
+}
+
+static void create_rows(lv_obj_t *list)
+{
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+
+    ext->rows[0] = create_row(list);
+    ext->row_h = lv_obj_get_height(ext->rows[0]);
+    uint8_t num_rows = (uint8_t)LV_MATH_MIN(VLIST_MAX_ROWS, lv_obj_get_height(list) / ext->row_h + 2);
+
+    ext->index[0] = NO_INDEX;
+    for (ext->num_rows = 1; ext->num_rows < num_rows; ext->num_rows++)
+    {
+        ext->rows[ext->num_rows] = create_row(list);
+        ext->index[ext->num_rows] = NO_INDEX;
+    }
+}
+
+static void fill_row(lv_obj_t *list, uint8_t slot, uint16_t index)
+{
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+    lv_obj_t *row = ext->rows[slot];
+    lv_obj_t *label = lv_obj_get_child(row, NULL); // last created
+    lv_obj_t *img = lv_obj_get_child(row, label);
+
+    vlist_row_t r;
+    r.symbol = NULL;
+    r.text[0] = '\0';
+    if (ext->row_cb)
+        ext->row_cb(list, index, &r);
+    r.text[VLIST_TEXT_LEN] = '\0';
+
+    lv_img_set_src(img, r.symbol ? r.symbol : LV_SYMBOL_DUMMY);
+    lv_label_set_text(label, r.text);
+    lv_obj_set_y(row, index * ext->row_h);
+    lv_obj_set_hidden(row, false);
+    ext->index[slot] = index;
+}
+
+static void refr_rows(lv_obj_t *list)
+{
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+    if (!ext->num_rows)
+        return;
+
+    lv_obj_t *scrl = lv_page_get_scrollable(list);
+    lv_coord_t y = -lv_obj_get_y(scrl);
+    uint16_t first = (y > 0) ? (uint16_t)(y / ext->row_h) : 0;
+
+    for (uint16_t i = first; i < first + ext->num_rows; i++)
+    {
+        uint8_t slot = i % ext->num_rows;
+        if (i >= ext->count)
+        {
+            if (ext->index[slot] != NO_INDEX)
+            {
+                lv_obj_set_hidden(ext->rows[slot], true);
+                ext->index[slot] = NO_INDEX;
+            }
+        }
+        else if (ext->index[slot] != i)
+            fill_row(list, slot, i);
+    }
+}
+
+static lv_res_t vlist_scrl_signal(lv_obj_t *scrl, lv_signal_t sign, void *param)
+{
+    lv_res_t res = ancestor_scrl_signal(scrl, sign, param);
+    if (res != LV_RES_OK)
+        return res;
+
+    // scrolled
+    if (sign == LV_SIGNAL_COORD_CHG)
+        refr_rows(lv_obj_get_parent(scrl));
+
+    return res;
+}
+
+static lv_res_t vlist_signal(lv_obj_t *list, lv_signal_t sign, void *param)
+{
+    lv_res_t res = ancestor_signal(list, sign, param);
+    if (res != LV_RES_OK)
+        return res;
+
+    if (sign == LV_SIGNAL_GET_TYPE)
+        return lv_obj_handle_get_type_signal((lv_obj_type_t *)param, "vlist");
+
+    if (sign == LV_SIGNAL_COORD_CHG)
+    {
+        // resized: rows for the new size
+        const lv_area_t *ori = (const lv_area_t *)param;
+        vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+        if (ext->num_rows && ((lv_area_get_width(ori) != lv_obj_get_width(list)) || (lv_area_get_height(ori) != lv_obj_get_height(list))))
+        {
+            for (uint8_t i = 0; i < ext->num_rows; i++)
+                lv_obj_del(ext->rows[i]);
+            ext->num_rows = 0;
+            vlist_set_count(list, ext->count);
+        }
+    }
+
+    return res;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+lv_obj_t *vlist_create(lv_obj_t *parent, vlist_row_cb_t row_cb)
+{
+    lv_obj_t *list = lv_page_create(parent, NULL);
+    if (!list)
+        return NULL;
+
+    if (!ancestor_signal)
+        ancestor_signal = lv_obj_get_signal_cb(list);
+
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_allocate_ext_attr(list, sizeof(vlist_ext_t));
+    if (!ext)
+    {
+        lv_obj_del(list);
+        return NULL;
+    }
+    memset((uint8_t *)ext + sizeof(lv_page_ext_t), 0, sizeof(vlist_ext_t) - sizeof(lv_page_ext_t));
+    ext->row_cb = row_cb;
+
+    lv_obj_set_signal_cb(list, vlist_signal);
+
+    // scrollable as high as all entries, rows placed by refr_rows()
+    lv_obj_t *scrl = lv_page_get_scrollable(list);
+    if (!ancestor_scrl_signal)
+        ancestor_scrl_signal = lv_obj_get_signal_cb(scrl);
+    lv_obj_set_signal_cb(scrl, vlist_scrl_signal);
+    lv_page_set_scrl_layout(list, LV_LAYOUT_OFF);
+    lv_page_set_scrollable_fit2(list, LV_FIT_PARENT, LV_FIT_NONE);
+    lv_obj_set_height(scrl, 0);
+
+    // look like a list
+    lv_theme_apply(list, LV_THEME_LIST);
+    return list;
+}
+
+void vlist_set_count(lv_obj_t *list, uint16_t count)
+{
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+    if (!ext->num_rows)
+        create_rows(list);
+
+    ext->count = LV_MATH_MIN(count, LV_COORD_MAX / ext->row_h); // row positions
+    lv_obj_set_height(lv_page_get_scrollable(list), ext->count * ext->row_h);
+    refr_rows(list);
+}
+
+uint16_t vlist_get_count(const lv_obj_t *list)
+{
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+    return ext->count;
+}
+
+void vlist_refresh(lv_obj_t *list)
+{
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+    for (uint8_t i = 0; i < ext->num_rows; i++)
+    {
+        lv_obj_set_hidden(ext->rows[i], true);
+        ext->index[i] = NO_INDEX;
+    }
+    vlist_set_count(list, ext->count);
+}
+
+uint8_t vlist_get_row_objs(const lv_obj_t *list)
+{
+    vlist_ext_t *ext = (vlist_ext_t *)lv_obj_get_ext_attr(list);
+    return ext->num_rows;
+}
+
+// ------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+// ------------------------------------------------------------------------
+// Virtual list: a few row buttons rebound to the model while scrolling
+// ------------------------------------------------------------------------
+
+#ifndef __VLIST_H__
+#define __VLIST_H__
+
+#define VLIST_MAX_ROWS 10 // row buttons, enough to fill the list and one more
+#define VLIST_TEXT_LEN 32 // characters of a row
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    const void *symbol;              // LV_SYMBOL_... or image, NULL: none
+    char text[VLIST_TEXT_LEN + 1];
+} vlist_row_t;
+
+// fill the row for the model entry (0..count-1)
+typedef void (*vlist_row_cb_t)(lv_obj_t *list, uint16_t index, vlist_row_t *row);
+
+// Page styled like an lv_list (LV_THEME_LIST). Clicking a row sends
+// LV_EVENT_VALUE_CHANGED to the list, with the index (uint32_t) as data.
+lv_obj_t *vlist_create(lv_obj_t *parent, vlist_row_cb_t row_cb);
+
+// The model has count entries. Only the rows in view (or scrolled into view)
+// are filled by the row callback, entries appended keep the rows in place;
+// the number of objects does not depend on count.
+void vlist_set_count(lv_obj_t *list, uint16_t count);
+uint16_t vlist_get_count(const lv_obj_t *list);
+
+// entries changed (not just appended): fill the rows in view again
+void vlist_refresh(lv_obj_t *list);
+
+// row buttons created
+uint8_t vlist_get_row_objs(const lv_obj_t *list);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __VLIST_H__
+
+// ------------------------------------------------------------------------
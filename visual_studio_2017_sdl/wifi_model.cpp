@@ -0,0 +1,132 @@
+// ------------------------------------------------------------------------
+// WiFi scan results: networks in scan order, deduplicated by SSID
+// ------------------------------------------------------------------------
+//
+// A scan reports a network once per access point and channel, so the same
+// SSID arrives many times. The SSIDs are kept back to back in one text
+// buffer, and per network just its offset and a hash; a new SSID is compared
+// by hash first and by text only if the hashes are equal. Both buffers grow
+// by doubling, so a few hundred networks cost a few allocations.
+
+#include "lvgl/lvgl.h"
+#include "gui.h"
+#include "wifi_model.h"
+
+typedef struct
+{
+    uint32_t hash;
+    uint16_t ofs;     // of the SSID in texts
+} network_t;
+
+static network_t *networks;
+static uint16_t num_networks, max_networks;
+
+static char *texts;
+static uint16_t texts_len, texts_size;
+
+// ------------------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------------------
+
+// FNV-1a
+static uint32_t get_hash(const char *text, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int32_t find(const char *ssid, uint32_t hash)
+{
+    for (uint16_t i = 0; i < num_networks; i++)
+    {
+        if ((networks[i].hash == hash) && !strcmp(&texts[networks[i].ofs], ssid))
+            return i;
+    }
+    return -1;
+}
+
+static bool grow(void **buf, uint16_t *size, uint16_t needed, uint16_t min_size, size_t item_size)
+{
+    if (needed <= *size)
+        return true;
+
+    uint16_t new_size = *size ? *size : min_size;
+    while (new_size < needed)
+        new_size *= 2;
+
+    void *new_buf = lv_mem_realloc(*buf, new_size * item_size);
+    if (!new_buf)
+        return false;
+    *buf = new_buf;
+    *size = new_size;
+    return true;
+}
+
+// ------------------------------------------------------------------------
+// API
+// ------------------------------------------------------------------------
+
+bool wifi_model_add(const char *ssid)
+{
+    size_t len = strlen(ssid);
+    if (!len || (num_networks >= WIFI_MODEL_MAX_NETWORKS))
+        return false;
+    if (len > WIFI_MODEL_SSID_LEN)
+        len = WIFI_MODEL_SSID_LEN;
+
+    char name[WIFI_MODEL_SSID_LEN + 1];
+    memcpy(name, ssid, len);
+    name[len] = '\0';
+
+    uint32_t hash = get_hash(name, len);
+    if (find(name, hash) >= 0)
+        return false;
+
+    if (!grow((void **)&networks, &max_networks, num_networks + 1, 16, sizeof(network_t))
+        || !grow((void **)&texts, &texts_size, (uint16_t)(texts_len + len + 1), 256, 1))
+    {
+        MY_LOG("WiFi model: out of memory");
+        return false;
+    }
+
+    network_t *n = &networks[num_networks++];
+    n->hash = hash;
+    n->ofs = texts_len;
+    memcpy(&texts[texts_len], name, len + 1);
+    texts_len += (uint16_t)(len + 1);
+    return true;
+}
+
+uint16_t wifi_model_get_count(void)
+{
+    return num_networks;
+}
+
+const char *wifi_model_get_ssid(uint16_t index)
+{
+    if (index >= num_networks)
+        return "";
+    return &texts[networks[index].ofs];
+}
+
+void wifi_model_clear(void)
+{
+    lv_mem_free(networks);
+    lv_mem_free(texts);
+    networks = NULL;
+    texts = NULL;
+    num_networks = max_networks = 0;
+    texts_len = texts_size = 0;
+}
+
+uint32_t wifi_model_get_mem_size(void)
+{
+    return max_networks * sizeof(network_t) + texts_size;
+}
+
+// ------------------------------------------------------------------------
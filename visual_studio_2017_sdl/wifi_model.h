@@ -0,0 +1,34 @@
+// ------------------------------------------------------------------------
+// WiFi scan results: networks in scan order, deduplicated by SSID
+// ------------------------------------------------------------------------
+
+#ifndef __WIFI_MODEL_H__
+#define __WIFI_MODEL_H__
+
+#define WIFI_MODEL_SSID_LEN      32  // as 802.11
+#define WIFI_MODEL_MAX_NETWORKS  512
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Append the network, unless its SSID is listed already (or it is empty).
+// Returns true if added.
+bool wifi_model_add(const char *ssid);
+
+uint16_t wifi_model_get_count(void);
+const char *wifi_model_get_ssid(uint16_t index);
+
+// new scan
+void wifi_model_clear(void);
+
+// bytes allocated for the networks
+uint32_t wifi_model_get_mem_size(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __WIFI_MODEL_H__
+
+// ------------------------------------------------------------------------